@@ -25,7 +25,9 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 // DEALINGS IN THE SOFTWARE.
 #include <algorithm>   // for max, transform, copy, min
+#include <array>       // for array
 #include <cctype>      // for isdigit, tolower
+#include <complex>     // for complex
 #include <cstdlib>     // for size_t, exit
 #include <filesystem>  // for getting program_name from path
 #include <iomanip>     // for operator<<, setw
@@ -57,6 +59,16 @@ namespace argparse {
   template <typename T, typename A>
   struct is_vector<std::vector<T, A>> : public std::true_type {};
 
+  template <typename T>
+  struct is_std_array : public std::false_type {};
+  template <typename T, size_t N>
+  struct is_std_array<std::array<T, N>> : public std::true_type {};
+
+  template <typename T>
+  struct is_complex : public std::false_type {};
+  template <typename T>
+  struct is_complex<std::complex<T>> : public std::true_type {};
+
   template <typename T>
   struct is_optional : public std::false_type {};
   template <typename T>
@@ -116,6 +128,19 @@ namespace argparse {
     }
   }
 
+  template <typename T, size_t N>
+  std::string toString(const std::array<T, N>& v) {
+    if constexpr (has_ostream_operator<T>::value) {
+      std::string val;
+      for (size_t i = 0; i < N; ++i) {
+        val += (i == 0 ? "" : ",") + toString(v[i]);
+      }
+      return val;
+    } else {
+      return "unknown";
+    }
+  }
+
   std::vector<std::string> inline split(const std::string& str) {
     std::vector<std::string> splits;
     std::stringstream        ss(str);
@@ -180,6 +205,10 @@ namespace argparse {
     return std::stod(v);
   }
   template <>
+  inline long double get(const std::string& v) {
+    return std::stold(v);
+  }
+  template <>
   inline unsigned char get(const std::string& v) {
     return get<char>(v);
   }
@@ -203,6 +232,34 @@ namespace argparse {
       T                              res(splitted.size());
       if (!v.empty()) std::transform(splitted.begin(), splitted.end(), res.begin(), get<typename T::value_type>);
       return res;
+    } else if constexpr (is_std_array<T>::value) {  // fixed number of comma-separated elements, parsed in place
+      T      res{};
+      size_t n     = 0;
+      size_t start = 0;
+      if (!v.empty()) {
+        for (size_t pos = 0; pos <= v.size(); ++pos) {
+          if (pos != v.size() && v[pos] != ',') continue;
+          if (n < res.size()) res[n] = get<typename T::value_type>(v.substr(start, pos - start));
+          ++n;
+          start = pos + 1;
+        }
+      }
+      if (n != res.size())
+        throw std::runtime_error("expected " + std::to_string(res.size()) + " elements, got " + std::to_string(n));
+      return res;
+    } else if constexpr (is_complex<T>::value) {  // accepts "re", "re,im" and "(re,im)"
+      size_t first = v.find_first_not_of(" \t");
+      size_t last  = v.find_last_not_of(" \t");
+      if (first == std::string::npos) throw std::invalid_argument("empty string");
+      if (v[first] == '(' && v[last] == ')') {
+        ++first;
+        --last;
+      }
+      const std::string body  = v.substr(first, last + 1 - first);
+      const size_t      comma = body.find(',');
+      if (comma == std::string::npos) return T(get<typename T::value_type>(body));
+      if (body.find(',', comma + 1) != std::string::npos) throw std::invalid_argument("too many complex components");
+      return T(get<typename T::value_type>(body.substr(0, comma)), get<typename T::value_type>(body.substr(comma + 1)));
     } else if constexpr (std::is_pointer<T>::value) {
       return new typename std::remove_pointer<T>::type(get<typename std::remove_pointer<T>::type>(v));
     } else if constexpr (is_shared_ptr<T>::value) {
@@ -333,6 +390,24 @@ namespace argparse {
       return ((ConvertType<T>*)(datap.get()))->data;
     }
 
+    // Typed value stored in the entry (the entry has to be created for type T), allows to set it without conversion
+    template <typename T>
+    T& typed_value() {
+      return ((ConvertType<T>*)(datap.get()))->data;
+    }
+    template <typename T>
+    const T& typed_value() const {
+      return ((const ConvertType<T>*)(datap.get()))->data;
+    }
+
+    // Restore string value, error and user flag saved elsewhere, the typed value is not converted and has to be restored
+    // separately with typed_value()
+    void restore(std::optional<std::string> value, std::string err, bool set_by_user) {
+      value_         = std::move(value);
+      error          = std::move(err);
+      is_set_by_user = set_by_user;
+    }
+
     // Force an ambiguous error when not using a reference.
     std::optional<std::string> string_value() const { return value_.has_value() ? value_ : std::nullopt; }
 
@@ -431,12 +506,24 @@ namespace argparse {
     }  // When you get here  because you received an error, make sure all parameters of argparse are references (e.g. with `&`)
   };
 
+  // Order of keys of key-worded arguments, that ignores case of the keys if case_insensitive is set
+  struct KeyLess {
+    bool case_insensitive = false;
+
+    bool operator()(const std::string& lhs, const std::string& rhs) const {
+      if (!case_insensitive) return lhs < rhs;
+      return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](unsigned char l, unsigned char r) {
+        return std::tolower(l) < std::tolower(r);
+      });
+    }
+  };
+
   class Args {
   private:
     size_t                                                  _arg_idx = 0;
     std::vector<std::string>                                params;
     std::vector<std::shared_ptr<Entry>>                     all_entries;
-    std::map<std::string, std::shared_ptr<Entry>>           kwarg_entries;
+    std::map<std::string, std::shared_ptr<Entry>, KeyLess>  kwarg_entries;
     std::vector<std::shared_ptr<Entry>>                     arg_entries;
     std::map<std::string, std::shared_ptr<SubcommandEntry>> subcommand_entries;
     bool&                                                   _help = flag("?,help", "print help");
@@ -573,6 +660,15 @@ namespace argparse {
       kwarg_entries[new_name] = kwarg_entries[old_key];
     }
 
+    /* Match keys of key-worded arguments ignoring their case.
+     * Keys are compared character by character ignoring their case, so that no keys are converted on lookup
+     */
+    void set_case_insensitive() {
+      std::map<std::string, std::shared_ptr<Entry>, KeyLess> entries(KeyLess{true});
+      for (const auto& [key, entry] : kwarg_entries) entries[key] = entry;
+      kwarg_entries.swap(entries);
+    }
+
     /* parse all parameters and also check for the help_flag which was set in this constructor
      * Upon error, it will print the error and exit immediately if validation_action is ValidationAction::EXIT_ON_ERROR
      */
@@ -48,15 +48,37 @@
 #include <ctype.h>   // for tolower() and toupper()
 #include <string.h>  // for strlen()
 
-#include <algorithm>   // for std::transform
-#include <cctype>      // for std::isspace()
-#include <fstream>     // for std::fstream
-#include <functional>  // for std::not1, std::ptr_fun
-#include <iomanip>     // for std::setprecision
-#include <map>         // for std::map
-#include <sstream>     // for std::stringstream
-#include <string>      // for std::string
-#include <vector>      // for std::vector
+#include <algorithm>     // for std::transform
+#include <atomic>        // for std::atomic
+#include <cctype>        // for std::isspace()
+#include <charconv>      // for std::from_chars, std::to_chars
+#include <cerrno>        // for errno
+#include <cmath>         // for std::fabs
+#include <cstdio>        // for std::rename
+#include <filesystem>    // for std::filesystem::permissions
+#include <fstream>       // for std::fstream
+#include <functional>    // for std::not1, std::ptr_fun
+#include <iomanip>       // for std::setprecision
+#include <iterator>      // for std::istreambuf_iterator
+#include <limits>        // for std::numeric_limits
+#include <map>           // for std::map
+#include <memory>        // for std::shared_ptr
+#include <mutex>         // for std::mutex
+#include <sstream>       // for std::stringstream
+#include <string>        // for std::string
+#include <string_view>   // for std::string_view
+#include <system_error>  // for std::errc
+#include <thread>        // for std::thread
+#include <type_traits>   // for std::is_arithmetic_v
+#include <vector>        // for std::vector
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>     // for open()
+#include <sys/mman.h>  // for mmap()
+#include <sys/stat.h>  // for fstat()
+#include <unistd.h>    // for close()
+#define INI_HAS_MMAP
+#endif
 /*---------------------------------------------------------------------------------------------------------------/
 / Defines & Settings
 /---------------------------------------------------------------------------------------------------------------*/
@@ -64,6 +86,34 @@
 // Error codes
 #define INI_ERR_INVALID_FILENAME -1  // Can't open file for reading or writing
 #define INI_ERR_PARSING_ERROR    -2  // File parse error
+#define INI_ERR_INCLUDE_CYCLE    -3  // File includes itself directly or through other files
+
+// Load flags (can be combined with '|')
+#define INI_LOAD_DEFAULT     0x0   // Read whole file into memory and parse it in place
+#define INI_LOAD_MMAP        0x1   // Memory-map files instead of reading them (falls back to reading where mmap is not available)
+#define INI_LOAD_LAZY        0x2   // Only index sections on load, parse each section when it is accessed for the first time
+#define INI_LOAD_PARALLEL    0x4   // Parse large files on several threads, split at sections (INI_LOAD_LAZY takes precedence)
+#define INI_LOAD_NO_COMMENTS 0x8   // Do not keep comments of sections and values (they are lost on saving)
+#define INI_LOAD_TYPED       0x10  // Convert numbers and arrays of numbers on load, numeric Get<T>() does not parse them again
+#define INI_LOAD_FOLD_CASE   0x20  // Store names of sections and values in lower case, they are looked up by lower case names
+
+// Minimal size of the text in bytes to be parsed by each thread with INI_LOAD_PARALLEL
+#ifndef INI_PARALLEL_CHUNK_SIZE
+#define INI_PARALLEL_CHUNK_SIZE 0x100000
+#endif
+
+// Default number of included files kept in the cache shared by all files of the process, the least recently used ones
+// are dropped first (0 disables the cache)
+#ifndef INI_INCLUDE_CACHE_SIZE
+#define INI_INCLUDE_CACHE_SIZE 64
+#endif
+
+// Nanoseconds of the modification time in struct stat
+#if defined(__APPLE__)
+#define INI_STAT_MTIME_NSEC(st) ((st).st_mtimespec.tv_nsec)
+#else
+#define INI_STAT_MTIME_NSEC(st) ((st).st_mtim.tv_nsec)
+#endif
 
 // INI file syntax can be changed here
 // NOTE: When saving INI files first characters of provided arrays are used
@@ -113,6 +163,10 @@
 
 // All parser-related stuff is in INI namespace
 namespace INI {
+  /// Array segment symbols, available to users after the configuration macros are undefined
+  constexpr char ARRAY_SEGMENT_OPEN  = INI_ARRAY_SEGMENT_OPEN;
+  constexpr char ARRAY_SEGMENT_CLOSE = INI_ARRAY_SEGMENT_CLOSE;
+
   /// String to lower case
   static inline void string_to_lower(std::string& str) { std::transform(str.begin(), str.end(), str.begin(), ::tolower); }
 
@@ -125,14 +179,73 @@ namespace INI {
     convstream() { *this << std::setprecision(17) << std::boolalpha; }
   };
 
+  /// Numeric types that are converted with std::from_chars / std::to_chars instead of convstream
+  /// (bool and character types keep their own textual representation)
+  template <class T>
+  constexpr bool is_charconv_type = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+                                    !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>;
+
+  /// Closest value of type T to the number in [@param first, @param last), that does not fit into T
+  /// Integers are clamped to the limits of T, floating numbers become the largest finite number or zero, the same way
+  /// stream extraction sets them on failure
+  template <class T>
+  T out_of_range_value(const char* first, const char* last) {
+    bool negative = first != last && *first == '-';
+    if constexpr (std::is_integral_v<T>) {
+      return negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    } else {
+      bool        overflow;
+      long double wide;
+      if (!std::is_same_v<T, long double> && std::from_chars(first, last, wide).ec == std::errc()) {
+        overflow = std::fabs(wide) > 1;
+      } else {
+        // the exponent is far outside the range of T, its sign tells overflow from underflow
+        const char* exp = std::find_if(first, last, [](char c) { return c == 'e' || c == 'E'; });
+        overflow        = exp == last || exp + 1 == last || exp[1] != '-';
+      }
+      T value = overflow ? std::numeric_limits<T>::max() : T(0);
+      return negative ? -value : value;
+    }
+  }
+
+  /// Convert characters in range [@param first, @param last) to number @param out
+  /// Leading whitespaces and '+' sign are skipped the same way stream extraction does
+  /// Conversion does not allocate and does not depend on current locale
+  /// Numbers that do not fit into T set @param out to the closest limit (see out_of_range_value), negative numbers are not
+  /// converted to unsigned types
+  /// @return true if at least one character was converted and the number fits into T, @param end (if not NULL) is set past
+  /// the last converted character
+  template <class T>
+  bool chars_to_t(const char* first, const char* last, T& out, const char** end = NULL) {
+    while (first != last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+    if (first != last && *first == '+' && (last - first) > 1 && *(first + 1) != '-') ++first;
+    std::from_chars_result res;
+    if constexpr (std::is_floating_point_v<T>)
+      res = std::from_chars(first, last, out, std::chars_format::general);
+    else
+      res = std::from_chars(first, last, out);
+    if (end) *end = res.ptr;
+    if (res.ec == std::errc::result_out_of_range) out = out_of_range_value<T>(first, res.ptr);
+    return res.ec == std::errc();
+  }
+
   /// Convert anything (int, double etc) to string
   template <class T>
   std::string t_to_string(const T& i) {
-    convstream  ss;
-    std::string s;
-    ss << i;
-    s = ss.str();
-    return s;
+    if constexpr (is_charconv_type<T>) {
+      // shortest representation that round-trips, large enough for any 128-bit integer or long double
+      char                 buf[64];
+      std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), i);
+      return std::string(buf, res.ptr);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      return i ? "true" : "false";
+    } else {
+      convstream  ss;
+      std::string s;
+      ss << i;
+      s = ss.str();
+      return s;
+    }
   }
   /// Special case for string (to avoid overheat)
   template <>
@@ -143,11 +256,17 @@ namespace INI {
   /// Convert string to anything (int, double, etc)
   template <class T>
   T string_to_t(const std::string& v) {
-    convstream ss;
-    T          out;
-    ss << v;
-    ss >> out;
-    return out;
+    if constexpr (is_charconv_type<T>) {
+      T out{};
+      chars_to_t(v.data(), v.data() + v.size(), out);
+      return out;
+    } else {
+      convstream ss;
+      T          out;
+      ss << v;
+      ss >> out;
+      return out;
+    }
   }
   /// Special case for string
   template <>
@@ -194,6 +313,13 @@ namespace INI {
   // Trim string from both ends
   static inline std::string&             trim(std::string& s) { return ltrim(rtrim(s)); }
 
+  // Trim string view from both ends (no copies are made)
+  static inline std::string_view         trim_view(std::string_view s) {
+    while (!s.empty() && __in_isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && __in_isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+  }
+
   /// Split strings (and trim result) based on the provided separator
   /// Strings in the vector would be trimmed as well
   static inline std::vector<std::string> split_string(const std::string& str, const std::string& sep) {
@@ -292,12 +418,15 @@ namespace INI {
   class Array;
   class Map;
   class Section;
+  class SectionStore;
   class File;
-  typedef std::vector<Section*> SectionVector;
+  typedef std::vector<Section*>       SectionVector;
+  typedef std::vector<const Section*> ConstSectionVector;
 
   /**
    * Reference-counting helper class
-   * This should be used as a member in reference-counting classes Value, Array and Map
+   * This should be used as a member in reference-counting classes Array and Map
+   * Reference count is atomic, so copies of the same object can be created and destroyed on different threads
    **/
   template <class T>
   class RefCountPtr {
@@ -339,43 +468,325 @@ namespace INI {
   private:
     void Decrement() {
       if (!_ptr) return;
-      _ptr->count--;
-      if (!_ptr->count) {
-        delete (_ptr);
-        _ptr = NULL;
-      }
+      if (_ptr->count.fetch_sub(1, std::memory_order_acq_rel) == 1) delete (_ptr);
+      _ptr = NULL;
     }
     void Increment() {
-      if (_ptr) _ptr->count++;
+      if (_ptr) _ptr->count.fetch_add(1, std::memory_order_relaxed);
     }
     struct refcont {
       refcont() : count(1) {}
       refcont(const T& pval) : val(pval), count(1) {}
-      T      val;
-      size_t count;
+      T                   val;
+      std::atomic<size_t> count;
     };
     refcont* _ptr;
   };
 
+  /**
+   * Associative container keeping key-value pairs in one vector sorted by key
+   * Provides the part of std::map interface used for sections and entries, iterators point to std::pair<K, V>
+   * Unlike std::map, insertion and removal invalidate iterators and references to elements. Keys must not be modified
+   **/
+  template <class K, class V>
+  class FlatMap {
+  public:
+    typedef std::pair<K, V>                                  value_type;
+    typedef typename std::vector<value_type>::iterator       iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+    iterator                                                 begin() { return _data.begin(); }
+    const_iterator                                           begin() const { return _data.begin(); }
+    iterator                                                 end() { return _data.end(); }
+    const_iterator                                           end() const { return _data.end(); }
+    size_t                                                   size() const { return _data.size(); }
+    bool                                                     empty() const { return _data.empty(); }
+    void                                                     clear() { _data.clear(); }
+
+    /// First element with key not less than @param key
+    iterator lower_bound(const K& key) { return std::lower_bound(_data.begin(), _data.end(), key, KeyLess()); }
+    const_iterator lower_bound(const K& key) const { return std::lower_bound(_data.begin(), _data.end(), key, KeyLess()); }
+    iterator       find(const K& key) {
+      iterator it = lower_bound(key);
+      return (it != _data.end() && it->first == key) ? it : _data.end();
+    }
+    const_iterator find(const K& key) const {
+      const_iterator it = lower_bound(key);
+      return (it != _data.end() && it->first == key) ? it : _data.end();
+    }
+    /// Insert @param val if its key is not in the container yet
+    /// @return iterator to the element with the key and whether insertion took place
+    std::pair<iterator, bool> insert(const value_type& val) {
+      iterator it = position(val.first);
+      if (it != _data.end() && it->first == val.first) return std::make_pair(it, false);
+      return std::make_pair(_data.insert(it, val), true);
+    }
+    /// Access value with @param key, default value is inserted if needed
+    V& operator[](const K& key) {
+      iterator it = position(key);
+      if (it == _data.end() || it->first != key) it = _data.insert(it, value_type(key, V()));
+      return it->second;
+    }
+    iterator erase(iterator it) { return _data.erase(it); }
+
+  private:
+    struct KeyLess {
+      bool operator()(const value_type& val, const K& key) const { return val.first < key; }
+    };
+    // keys are often added in order, so the end is checked before binary search
+    iterator position(const K& key) {
+      if (_data.empty() || _data.back().first < key) return _data.end();
+      return lower_bound(key);
+    }
+    std::vector<value_type> _data;
+  };
+
+  /**
+   * Immutable text INI files are parsed from
+   * Either owns a copy of the text or keeps a read-only memory mapping of the file
+   * Values parsed from the buffer refer to its text instead of copying it
+   **/
+  class TextBuffer {
+  public:
+    TextBuffer(const TextBuffer&)            = delete;
+    TextBuffer& operator=(const TextBuffer&) = delete;
+    ~TextBuffer() {
+#ifdef INI_HAS_MMAP
+      if (_mapped) munmap(const_cast<char*>(_data), _size);
+#endif
+    }
+
+    /// Create buffer that owns @param text
+    static std::shared_ptr<const TextBuffer> FromString(std::string text) {
+      std::shared_ptr<TextBuffer> buf(new TextBuffer());
+      buf->_text = std::move(text);
+      buf->_data = buf->_text.data();
+      buf->_size = buf->_text.size();
+      return buf;
+    }
+    /// Create buffer that refers to @param text owned by the caller without copying it
+    /// The text has to stay valid as long as the buffer exists
+    static std::shared_ptr<const TextBuffer> FromView(std::string_view text) {
+      std::shared_ptr<TextBuffer> buf(new TextBuffer());
+      buf->_data     = text.data();
+      buf->_size     = text.size();
+      buf->_borrowed = true;
+      return buf;
+    }
+    /// Read whole file @param fname into memory
+    /// @return NULL if file can not be opened
+    static std::shared_ptr<const TextBuffer> ReadFile(const std::string& fname) {
+      std::ifstream file(fname.c_str(), std::ios::in | std::ios::binary);
+      if (!file.is_open()) return NULL;
+      std::string text;
+      file.seekg(0, std::ios::end);
+      std::streamoff size = file.tellg();
+      file.seekg(0, std::ios::beg);
+      if (size > 0) {
+        text.resize(static_cast<size_t>(size));
+        file.read(&text[0], size);
+        text.resize(static_cast<size_t>(file.gcount()));
+      }
+      return FromString(std::move(text));
+    }
+    /// Map file @param fname into memory (falls back to ReadFile where mapping is not available)
+    /// @return NULL if file can not be opened
+    static std::shared_ptr<const TextBuffer> MapFile(const std::string& fname) {
+#ifdef INI_HAS_MMAP
+      int fd = open(fname.c_str(), O_RDONLY);
+      if (fd < 0) return NULL;
+      struct stat st;
+      if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+      }
+      return FromDescriptor(fd, st, true);
+#else
+      return ReadFile(fname);
+#endif
+    }
+#ifdef INI_HAS_MMAP
+    /// Read file opened as @param fd with status @param st, file is mapped into memory if @param map is set
+    /// @param fd is closed
+    /// @return NULL if file can not be read
+    static std::shared_ptr<const TextBuffer> FromDescriptor(int fd, const struct stat& st, bool map) {
+      if (map && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* addr = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+          close(fd);
+          std::shared_ptr<TextBuffer> buf(new TextBuffer());
+          buf->_data   = static_cast<const char*>(addr);
+          buf->_size   = static_cast<size_t>(st.st_size);
+          buf->_mapped = true;
+          return buf;
+        }
+      }
+      std::string text;
+      if (st.st_size > 0) text.reserve(static_cast<size_t>(st.st_size));
+      char    block[0x10000];
+      ssize_t n;
+      while ((n = read(fd, block, sizeof(block))) != 0) {
+        if (n > 0)
+          text.append(block, static_cast<size_t>(n));
+        else if (errno != EINTR)
+          break;
+      }
+      close(fd);
+      if (n < 0) return NULL;
+      return FromString(std::move(text));
+    }
+#endif
+
+    std::string_view View() const { return std::string_view(_data, _size); }
+    bool             IsMapped() const { return _mapped; }
+    bool             IsBorrowed() const { return _borrowed; }
+
+  private:
+    TextBuffer() : _data(NULL), _size(0), _mapped(false), _borrowed(false) {}
+    std::string _text;
+    const char* _data;
+    size_t      _size;
+    bool        _mapped;
+    bool        _borrowed;
+  };
+
+  /**
+   * Single-pass tokenizer of strings with Array and Map values
+   * Elements are reported as parts of the tokenized string, own copy is made only for elements with escaped characters
+   * or segments in the middle. Segments, escapes and whitespace are handled the same way as by Array and Map
+   **/
+  class ArrayTokenizer {
+  public:
+    ArrayTokenizer(std::string_view str, char sep = INI_ARRAY_DELIMITER, char seg_open = INI_ARRAY_SEGMENT_OPEN,
+                   char seg_close = INI_ARRAY_SEGMENT_CLOSE, char esc = INI_ESCAPE_CHARACTER) :
+        _str(str), _pos(str.empty() ? 1 : 0), _sep(sep), _seg_open(seg_open), _seg_close(seg_close), _esc(esc), _kval(0),
+        _has_kval(false), _segm_cnt(0), _escaped(false), _preesc(0) {}
+    /// Split elements to keys and values with @param kval (as for Map)
+    void SetKeyDelimiter(char kval) {
+      _kval     = kval;
+      _has_kval = true;
+    }
+
+    /// Read next element to @param element
+    /// Returned views are valid until the next call
+    /// @return false if there are no more elements
+    bool Next(std::string_view& element) {
+      std::string_view key;
+      return Next(key, element);
+    }
+    /// Read next element to @param element and its key to @param key (empty if element has no key)
+    bool Next(std::string_view& key, std::string_view& element) {
+      _key.Clear();
+      _cur.Clear();
+      for (; _pos <= _str.size(); ++_pos) {
+        size_t i = _pos;
+        if (_escaped && i < _str.size()) {
+          _cur.Append(_str, i);
+          _escaped = false;
+          if (_str[i] == _esc) _preesc = 2;
+        } else if ((i == _str.size()) || (_str[i] == _sep && !_segm_cnt)) {
+          key     = _key.View(_str);
+          element = _cur.View(_str);
+          if (_preesc) _preesc--;
+          ++_pos;
+          return true;
+        } else if (_has_kval && _str[i] == _kval && !_segm_cnt) {
+          std::swap(_key, _cur);
+          _cur.Clear();
+        } else if (_str[i] == _seg_open && !_preesc) {
+          if (_segm_cnt) _cur.Append(_str, i);
+          _segm_cnt++;
+        } else if (_str[i] == _seg_close && !_preesc) {
+          _segm_cnt--;
+          if (_segm_cnt < 0) _segm_cnt = 0;
+          if (_segm_cnt) _cur.Append(_str, i);
+        } else if (_str[i] == _esc)
+          _escaped = true;
+        else
+          _cur.Append(_str, i);
+        if (_preesc) _preesc--;
+      }
+      return false;
+    }
+
+  private:
+    /// Characters of the element being read
+    /// It refers to the tokenized string while characters are contiguous in it
+    struct Piece {
+      Piece() : begin(0), end(0), copied(false) {}
+      void Append(std::string_view str, size_t i) {
+        if (copied)
+          copy.push_back(str[i]);
+        else if (begin == end) {
+          begin = i;
+          end   = i + 1;
+        } else if (end == i)
+          ++end;
+        else {
+          copy.assign(str.substr(begin, end - begin));
+          copy.push_back(str[i]);
+          copied = true;
+        }
+      }
+      std::string_view View(std::string_view str) const { return trim_view(copied ? copy : str.substr(begin, end - begin)); }
+      void             Clear() {
+        begin = end = 0;
+        copied      = false;
+        copy.clear();
+      }
+      size_t      begin;
+      size_t      end;
+      bool        copied;
+      std::string copy;
+    };
+    std::string_view _str;
+    size_t           _pos;
+    char             _sep;
+    char             _seg_open;
+    char             _seg_close;
+    char             _esc;
+    char             _kval;
+    bool             _has_kval;
+    int              _segm_cnt;  // depth of segments
+    bool             _escaped;   // previous character was escape character
+    int              _preesc;    // segment characters right after escaped escape character are not special
+    Piece            _key;
+    Piece            _cur;
+  };
+
   /**
    * Value to be stored in INI-file
-   * This is a simple reference-counting class, storing a pointer to original string
+   * Short strings are stored inline, longer ones refer to an immutable shared TextBuffer: either the text of the file
+   * the value was parsed from or own copy of the string made when value is set. Copies never allocate memory
+   * Inline string shares storage with the view of the shared text, numbers converted by Classify() own the shared text
    * It has some functions for easy converting to\from other types
    * Value can contain array (in string representation) and be converted to\from it
    **/
   class Value {
   public:
-    Value() {}
-    Value(const Value& cp) : _val(cp._val) {}
+    Value() : _small_size(INVALID_SIZE), _typed(false) {}
+    Value(const Value& cp) : _typed(false) { Assign(cp); }
+    Value(Value&& cp) noexcept : _typed(false) { Assign(std::move(cp)); }
+    /// Value referring to the part @param view of the text @param buf (short values are copied)
+    Value(std::string_view view, const std::shared_ptr<const TextBuffer>& buf) : _typed(false) {
+      if (view.size() <= SMALL_SIZE)
+        SetSmall(view);
+      else
+        SetShared(view, buf);
+    }
     template <class T>
-    Value(const T& val) {
+    Value(const T& val) : _typed(false) {
       Set(val);
     }
-    Value(const char* value) { Set(value); }
+    Value(const char* value) : _typed(false) { Set(value); }
     virtual ~Value() {}
 
     Value& operator=(const Value& rt) {
-      _val = rt._val;
+      if (this != &rt) Assign(rt);
+      return *this;
+    }
+    Value& operator=(Value&& rt) noexcept {
+      if (this != &rt) Assign(std::move(rt));
       return *this;
     }
     template <class T>
@@ -383,51 +794,287 @@ namespace INI {
       Set(value);
       return *this;
     }
-    bool operator==(const Value& rgh) const { return _val == rgh._val; }
+    bool operator==(const Value& rgh) const {
+      if (!IsValid() || !rgh.IsValid()) return IsValid() == rgh.IsValid();
+      return View() == rgh.View();
+    }
     bool operator!=(const Value& val) const { return !(*this == val); }
     bool operator<(const Value& rgh) const {
-      if (!_val.IsValid()) return true;
-      if (!rgh._val.IsValid()) return false;
-      return (_val.Data() < rgh._val.Data());
+      if (!IsValid()) return true;
+      if (!rgh.IsValid()) return false;
+      return (View() < rgh.View());
     }
 
     /// Template function to convert value to any type
+    /// Numbers converted by Classify() are returned without parsing the text, when they convert to T exactly as the text
     template <class T>
     T Get() const {
-      return string_to_t<T>(_val.DataObj());
+      if constexpr (is_charconv_type<T>) {
+        T out;
+        if (const Numbers* numbers = Typed(); numbers && !numbers->array && numbers->Get(0, out)) return out;
+      }
+      return Convert<T>(View());
+    }
+    /// Convert value to number @param out, reporting conversion failures that Get<T>() does not
+    /// @return false if the text is not a single number (surrounding whitespaces are allowed), if the number does not fit
+    /// into T (@param out is set to the closest limit) or if it is negative and T is unsigned (@param out is set to 0)
+    template <class T>
+    bool TryGet(T& out) const {
+      static_assert(is_charconv_type<T>, "TryGet converts only numbers");
+      if (const Numbers* numbers = Typed(); numbers && !numbers->array && numbers->Get(0, out)) return true;
+      std::string_view v   = View();
+      const char*      end = v.data();
+      out                  = T();
+      bool ok              = chars_to_t(v.data(), v.data() + v.size(), out, &end);
+      while (end != v.data() + v.size() && std::isspace(static_cast<unsigned char>(*end))) ++end;
+      return ok && end == v.data() + v.size();
+    }
+    /// Convert text @param v to type T the same way as Get<T>() does
+    /// Numbers are converted from the beginning of the text, numbers out of range of T are clamped to its limits
+    template <class T>
+    static T Convert(std::string_view v) {
+      if constexpr (is_charconv_type<T>) {
+        T out{};
+        chars_to_t(v.data(), v.data() + v.size(), out);
+        return out;
+      } else if constexpr (std::is_same_v<T, bool>) {
+        return !v.empty() && (v[0] == '1' || v[0] == 't' || v[0] == 'T' || v[0] == 'Y' || v[0] == 'y');
+      } else {
+        return string_to_t<T>(std::string(v));
+      }
+    }
+    void Set(const std::string& str) { Set(std::string_view(str)); }
+    void Set(std::string_view str) {
+      if (str.size() <= SMALL_SIZE) {
+        SetSmall(str);
+        return;
+      }
+      std::shared_ptr<const TextBuffer> buf = TextBuffer::FromString(std::string(str));
+      SetShared(buf->View(), buf);
     }
-    void Set(const std::string& str) { _val = RefCountPtr<std::string>(str); }
     /// Template function to set value
     template <class T>
     void Set(const T& value) {
       Set(t_to_string(value));
     }
     // const char* (as any pointer) is defaulting in template to int or bool, which is not what we want
-    void        Set(const char* value) { _val = RefCountPtr<std::string>(std::string(value)); }
+    void             Set(const char* value) { Set(std::string(value)); }
 
     /// Converts Value to std::string
-    std::string AsString() const { return _val.DataObj(); }
+    std::string      AsString() const { return std::string(View()); }
+    /// Text of the Value without copying it, valid while Value exists
+    std::string_view View() const {
+      if (_small_size == SHARED_SIZE) return _view;
+      if (_small_size == INVALID_SIZE) return std::string_view();
+      return std::string_view(_small, _small_size);
+    }
     /// Converts Value to integer
-    int         AsInt() const { return Get<int>(); }
+    int    AsInt() const { return Get<int>(); }
     /// Converts Value to double
-    double      AsDouble() const { return Get<double>(); }
+    double AsDouble() const { return Get<double>(); }
     /// Converts Value to boolean
-    bool        AsBool() const { return Get<bool>(); }
+    bool   AsBool() const { return Get<bool>(); }
     /// Converts Value to Array
-    Array       AsArray() const;
+    Array  AsArray() const;
     /// Converts Value to Map
-    Map         AsMap() const;
+    Map    AsMap() const;
+    /// Converts elements of Value in Array representation to vector of type T without creating Array
+    template <class T>
+    std::vector<T> AsVector() const {
+      std::vector<T> ret;
+      if constexpr (is_charconv_type<T>) {
+        if (const Numbers* numbers = Typed(); numbers && numbers->Get(ret)) return ret;
+      }
+      ArrayTokenizer   tok(View());
+      std::string_view element;
+      while (tok.Next(element)) ret.push_back(Convert<T>(element));
+      return ret;
+    }
     /// Converts Value to specified type T
     template <class T>
     T AsT() const {
       return Get<T>();
     }
     /// Check if value is valid
-    bool IsValid() const { return _val.IsValid(); }
+    bool IsValid() const { return _small_size != INVALID_SIZE; }
+    /// Make own copy of the text, if Value refers to a memory-mapped file or to the text of the caller (File::LoadText)
+    void Detach() {
+      std::shared_ptr<const TextBuffer> buf = Text();
+      if (!buf || !(buf->IsMapped() || buf->IsBorrowed())) return;
+      buf   = TextBuffer::FromString(std::string(_view));
+      _view = buf->View();
+      if (!_typed) {
+        _owner = std::move(buf);
+        return;
+      }
+      std::shared_ptr<Numbers> numbers = std::make_shared<Numbers>(*Typed());
+      numbers->text                    = std::move(buf);
+      _owner                           = std::move(numbers);
+    }
+    /// Convert the text to a number or an array of numbers once, so that Get<T>() and AsVector<T>() of numeric types
+    /// do not parse it again. Text stays unchanged and conversions give the same results as for untyped Value
+    /// Value stays untyped, if its text is not a number or an array of numbers
+    void Classify() {
+      Untype();
+      std::string_view text = View();
+      if (text.empty()) return;
+      std::shared_ptr<Numbers> numbers = std::make_shared<Numbers>();
+      if (text.find(INI_ARRAY_DELIMITER) == std::string_view::npos) {
+        numbers->integer = Numbers::Parse(text, numbers->integer_value);
+        if (!numbers->integer && !Numbers::Parse(text, numbers->real_value)) return;
+      } else {
+        numbers->array   = true;
+        numbers->integer = true;
+        ArrayTokenizer   tok(text);
+        std::string_view element;
+        while (tok.Next(element)) {
+          long long i;
+          double    d;
+          if (numbers->integer && Numbers::Parse(element, i)) {
+            numbers->integers.push_back(i);
+            continue;
+          }
+          if (!Numbers::Parse(element, d)) return;
+          if (numbers->integer) {
+            numbers->integer = false;
+            numbers->reals.assign(numbers->integers.begin(), numbers->integers.end());
+            numbers->integers.clear();
+          }
+          numbers->reals.push_back(d);
+        }
+      }
+      numbers->text = Text();
+      _owner        = std::move(numbers);
+      _typed        = true;
+    }
+    /// Check if the text was converted to numbers by Classify()
+    bool IsTyped() const { return _typed; }
 
   private:
-    RefCountPtr<std::string> _val;
+    // numbers of the text converted by Classify()
+    struct Numbers {
+      // all numbers are integers, otherwise they are stored as reals
+      bool                   integer       = false;
+      // text is an array of numbers in integers or reals, otherwise a single number in integer_value or real_value
+      bool                   array         = false;
+      long long              integer_value = 0;
+      double                 real_value    = 0;
+      std::vector<long long> integers;
+      std::vector<double>    reals;
+      // shared text of the value, NULL for inline text
+      std::shared_ptr<const TextBuffer> text;
+
+      /// Convert the whole text @param v to number @param out the same way as Value::Convert does
+      template <class N>
+      static bool Parse(std::string_view v, N& out) {
+        const char* end;
+        if (!chars_to_t(v.data(), v.data() + v.size(), out, &end) || end != v.data() + v.size()) return false;
+        // "-0" is kept as a real number, so that its sign is not lost when converted to floating types
+        if constexpr (std::is_integral_v<N>) return out != 0 || v.find('-') == std::string_view::npos;
+        return true;
+      }
+      /// Set @param out to integer @param v, if Value::Convert<T> gives the same for its text
+      template <class T>
+      static bool Cast(long long v, T& out) {
+        if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+          if (v < static_cast<long long>(std::numeric_limits<T>::min()) ||
+              v > static_cast<long long>(std::numeric_limits<T>::max()))
+            return false;
+        } else if constexpr (std::is_integral_v<T>) {
+          if (v < 0 || static_cast<unsigned long long>(v) > std::numeric_limits<T>::max()) return false;
+        }
+        // conversion of integers is exact or rounded to the nearest floating number, as parsing their text is
+        out = static_cast<T>(v);
+        return true;
+      }
+      /// Set @param out to real @param v, if Value::Convert<T> gives the same for its text
+      template <class T>
+      static bool Cast([[maybe_unused]] double v, [[maybe_unused]] T& out) {
+        // text of a real number is only rounded the same way, when it is parsed as double
+        if constexpr (std::is_same_v<T, double>) {
+          out = v;
+          return true;
+        }
+        return false;
+      }
+      /// Get @param i-th number (0 for single number) as @param out
+      template <class T>
+      bool Get(size_t i, T& out) const {
+        if (integer) return Cast(array ? integers[i] : integer_value, out);
+        return Cast(array ? reals[i] : real_value, out);
+      }
+      /// Get all numbers as @param out
+      template <class T>
+      bool Get(std::vector<T>& out) const {
+        out.resize(array ? (integer ? integers.size() : reals.size()) : 1);
+        for (size_t i = 0; i < out.size(); ++i) {
+          if (!Get(i, out[i])) {
+            out.clear();
+            return false;
+          }
+        }
+        return true;
+      }
+    };
+
+    // longest string stored inline, the inline string takes the place of the view of the shared text
+    static constexpr unsigned char SMALL_SIZE   = sizeof(std::string_view);
+    // size of the inline string of Value that refers to the shared text
+    static constexpr unsigned char SHARED_SIZE  = 0xfe;
+    // size of the inline string of invalid Value
+    static constexpr unsigned char INVALID_SIZE = 0xff;
+
+    /// Numbers converted by Classify(), NULL for untyped values
+    const Numbers*                 Typed() const { return _typed ? static_cast<const Numbers*>(_owner.get()) : nullptr; }
+    /// Shared text the value refers to, NULL for inline and invalid values
+    std::shared_ptr<const TextBuffer> Text() const {
+      if (_small_size != SHARED_SIZE) return nullptr;
+      return _typed ? Typed()->text : std::static_pointer_cast<const TextBuffer>(_owner);
+    }
+    /// Forget numbers converted by Classify(), keeping the text
+    void Untype() {
+      if (!_typed) return;
+      std::shared_ptr<const void> text = Typed()->text;
+      _owner                           = std::move(text);
+      _typed                           = false;
+    }
+    void SetSmall(std::string_view str) {
+      _owner.reset();
+      _typed = false;
+      std::copy(str.begin(), str.end(), _small);
+      _small_size = static_cast<unsigned char>(str.size());
+    }
+    void SetShared(std::string_view view, const std::shared_ptr<const TextBuffer>& buf) {
+      _owner      = buf;
+      _typed      = false;
+      _view       = view;
+      _small_size = SHARED_SIZE;
+    }
+    template <class V>
+    void Assign(V&& cp) {
+      _small_size = cp._small_size;
+      if (_small_size == SHARED_SIZE)
+        _view = cp._view;
+      else if (_small_size != INVALID_SIZE)
+        std::copy(cp._small, cp._small + _small_size, _small);
+      _typed = cp._typed;
+      _owner = std::forward<V>(cp)._owner;
+    }
+
+    // shared text (TextBuffer) of the value or, if _typed, Numbers converted by Classify(); NULL for inline text
+    std::shared_ptr<const void> _owner;
+    union {
+      // part of the shared text, if _small_size is SHARED_SIZE
+      std::string_view _view;
+      // inline string otherwise
+      char             _small[SMALL_SIZE];
+    };
+    unsigned char _small_size;
+    bool          _typed;
   };
+  // Value is as small as a pointer to its text or numbers and an inline string, besides the pointer to virtual table
+  static_assert(sizeof(Value) <= 2 * sizeof(void*) + sizeof(std::shared_ptr<const void>) + sizeof(std::string_view),
+                "INI::Value is larger than intended");
 
   /**
    * Array of Values
@@ -518,33 +1165,9 @@ namespace INI {
                     char seg_close = INI_ARRAY_SEGMENT_CLOSE, char esc = INI_ESCAPE_CHARACTER) {
       _val.Copy();
       _val->clear();
-      if (str.empty()) return;
-      std::string cur_str;
-      int         segm_cnt = 0;
-      bool        escaped  = false;
-      int         preesc   = 0;
-      for (size_t i = 0; i <= str.size(); ++i) {
-        if (escaped && i < str.size()) {
-          cur_str.push_back(str[i]);
-          escaped = false;
-          if (str[i] == esc) preesc = 2;
-        } else if ((i == str.size()) || (str[i] == sep && !segm_cnt)) {
-          trim(cur_str);
-          _val->push_back(cur_str);
-          cur_str.clear();
-        } else if (str[i] == seg_open && !preesc) {
-          if (segm_cnt) cur_str.push_back(str[i]);
-          segm_cnt++;
-        } else if (str[i] == seg_close && !preesc) {
-          segm_cnt--;
-          if (segm_cnt < 0) segm_cnt = 0;
-          if (segm_cnt) cur_str.push_back(str[i]);
-        } else if (str[i] == esc)
-          escaped = true;
-        else
-          cur_str.push_back(str[i]);
-        if (preesc) preesc--;
-      }
+      ArrayTokenizer   tok(str, sep, seg_open, seg_close, esc);
+      std::string_view element;
+      while (tok.Next(element)) _val->push_back(Value(element));
     }
     template <class T>
     std::vector<T> ToVector() const {
@@ -574,8 +1197,8 @@ namespace INI {
   }
   template <>
   inline Array Value::Get<Array>() const {
-    if (!_val.IsValid()) return Array();
-    return Array(_val.Data());
+    if (!IsValid()) return Array();
+    return Array(AsString());
   }
   inline Array Value::AsArray() const { return Get<Array>(); }
 
@@ -584,6 +1207,8 @@ namespace INI {
    * Reference-counting class
    **/
   class Map {
+    typedef FlatMap<Value, Value> ValueMap;
+
   public:
     Map() {}
     Map(const Map& cp) : _val(cp._val) {}
@@ -611,14 +1236,14 @@ namespace INI {
     /// If there is no specified key - returns @param def_val
     Value GetValue(const Value& key, const Value& def_val = Value()) const {
       if (!_val.IsValid()) return def_val;
-      std::map<Value, Value>::const_iterator it = _val->find(key);
+      ValueMap::const_iterator it = _val->find(key);
       if (it == _val->end()) return def_val;
       return it->second;
     }
     /// Sets value @param value to specified key @param key
     void SetValue(const Value& key, const Value& value) {
       _val.Copy();
-      std::pair<std::map<Value, Value>::iterator, bool> res = _val->insert(std::pair<Value, Value>(key, value));
+      std::pair<ValueMap::iterator, bool> res = _val->insert(std::pair<Value, Value>(key, value));
       if (!res.second) res.first->second = value;
     }
     /// Returns map size
@@ -633,7 +1258,7 @@ namespace INI {
                          char esc = INI_ESCAPE_CHARACTER) const {
       std::string ret;
       if (!_val.IsValid()) return ret;
-      for (std::map<Value, Value>::const_iterator it = _val->begin(); it != _val->end(); ++it) {
+      for (ValueMap::const_iterator it = _val->begin(); it != _val->end(); ++it) {
         if (it != _val->begin()) ret += sep;
         std::string key = it->first.AsString();
         std::string out_key;
@@ -670,47 +1295,16 @@ namespace INI {
                     char esc = INI_ESCAPE_CHARACTER) {
       _val.Copy();
       _val->clear();
-      if (str.empty()) return;
-      std::string cur_str;
-      std::string cur_key;
-      int         segm_cnt = 0;
-      bool        escaped  = false;
-      int         preesc   = 0;
-      for (size_t i = 0; i <= str.size(); ++i) {
-        if (escaped && i < str.size()) {
-          cur_str.push_back(str[i]);
-          escaped = false;
-          if (str[i] == esc) preesc = 2;
-        } else if ((i == str.size()) || (str[i] == sep && !segm_cnt)) {
-          trim(cur_str);
-          std::pair<std::map<Value, Value>::iterator, bool> res =
-              _val->insert(std::pair<Value, Value>(Value(cur_key), Value(cur_str)));
-          if (!res.second) res.first->second = cur_str;
-          cur_str.clear();
-          cur_key.clear();
-        } else if (str[i] == kval && !segm_cnt) {
-          trim(cur_str);
-          cur_key = cur_str;
-          cur_str.clear();
-        } else if (str[i] == seg_open && !preesc) {
-          if (segm_cnt) cur_str.push_back(str[i]);
-          segm_cnt++;
-        } else if (str[i] == seg_close && !preesc) {
-          segm_cnt--;
-          if (segm_cnt < 0) segm_cnt = 0;
-          if (segm_cnt) cur_str.push_back(str[i]);
-        } else if (str[i] == esc)
-          escaped = true;
-        else
-          cur_str.push_back(str[i]);
-        if (preesc) preesc--;
-      }
+      ArrayTokenizer tok(str, sep, seg_open, seg_close, esc);
+      tok.SetKeyDelimiter(kval);
+      std::string_view key, element;
+      while (tok.Next(key, element)) _val.Data()[Value(key)] = Value(element);
     }
     template <class T, class M>
     std::map<T, M> ToMap() const {
       std::map<T, M> ret;
       if (!_val.IsValid()) return ret;
-      for (std::map<Value, Value>::const_iterator it = _val->begin(); it != _val->end(); ++it)
+      for (ValueMap::const_iterator it = _val->begin(); it != _val->end(); ++it)
         ret.insert(std::pair<T, M>(it->first.AsT<T>(), it->second.AsT<M>()));
       return ret;
     }
@@ -727,7 +1321,7 @@ namespace INI {
     void  FromValue(const Value& val) { FromString(val.AsString()); }
 
   private:
-    RefCountPtr<std::map<Value, Value>> _val;
+    RefCountPtr<ValueMap> _val;
   };
 
   template <>
@@ -736,8 +1330,8 @@ namespace INI {
   }
   template <>
   inline Map Value::Get<Map>() const {
-    if (!_val.IsValid()) return Map();
-    return Map(_val.Data());
+    if (!IsValid()) return Map();
+    return Map(AsString());
   }
   inline Map Value::AsMap() const { return Get<Map>(); }
 
@@ -745,15 +1339,102 @@ namespace INI {
   / INI file creation and parsing
   /---------------------------------------------------------------------------------------------------------------*/
 
+  /**
+   * Reads logical lines from the text of ini-file
+   * Lines are trimmed, lines ending with one of INI_MULTILINE_CHARS are joined with the following ones
+   * Empty lines are reported as well (even inside of multiline strings), they separate comments from sections and values
+   **/
+  class LineReader {
+  public:
+    /// Read lines of @param text between @param begin and @param end offsets, @param first_line is the number of the first line
+    LineReader(std::string_view text, size_t begin = 0, size_t end = std::string_view::npos, int first_line = 1) :
+        _text(text.substr(0, end)), _next(begin), _line_num(first_line - 1), _start(std::string_view::npos), _start_num(0),
+        _offset(0), _first_num(0) {}
+
+    /// Read next line to @param line
+    /// @param in_text is set to false if the line is joined from several lines and does not refer to the text
+    /// @return false if there are no more lines
+    bool Next(std::string_view& line, bool& in_text) {
+      while (_next <= _text.size()) {
+        size_t eol = _text.find('\n', _next);
+        if (eol == std::string_view::npos) eol = _text.size();
+        size_t offset = _next;
+        line          = trim_view(_text.substr(_next, eol - _next));
+        _next         = eol + 1;
+        ++_line_num;
+        in_text = true;
+        if (line.empty()) return true;
+        if (_start == std::string_view::npos) {
+          _start     = offset;
+          _start_num = _line_num;
+        }
+        // Handle multiline strings
+        if (char_is_one_of(line.back(), INI_MULTILINE_CHARS)) {
+          _prev_line.append(line.data(), line.size() - 1);
+          continue;
+        } else if (!_prev_line.empty()) {
+          _joined_line = _prev_line;
+          _joined_line.append(line.data(), line.size());
+          line    = _joined_line;
+          in_text = false;
+          _prev_line.clear();
+        }
+        _offset    = _start;
+        _first_num = _start_num;
+        _start     = std::string_view::npos;
+        return true;
+      }
+      return false;
+    }
+    /// Number of the last read line in the text
+    int    LineNumber() const { return _line_num; }
+    /// Offset past the last read line and its line break
+    size_t End() const { return std::min(_next, _text.size()); }
+    /// Offset of the first line of unfinished multiline string at the end of the text, npos if there is none
+    size_t Unfinished() const { return _start; }
+    /// Offset of the first line, the last non-empty line was joined from
+    size_t Offset() const { return _offset; }
+    /// Number of the first line, the last non-empty line was joined from
+    int    FirstLineNumber() const { return _first_num; }
+
+  private:
+    std::string_view _text;
+    std::string      _prev_line;
+    std::string      _joined_line;
+    size_t           _next;       // offset of the next line
+    int              _line_num;   // number of the last read line
+    size_t           _start;      // offset of the first line of the line being joined
+    int              _start_num;  // number of the first line of the line being joined
+    size_t           _offset;     // offset of the first line of the last non-empty line
+    int              _first_num;  // number of the first line of the last non-empty line
+  };
+
+  /// Part of the text of ini-file
+  struct TextChunk {
+    size_t begin;  // offset of the first character
+    size_t end;    // offset past the last character
+    int    line;   // number of the first line
+  };
+
+  /// Node of the tree of section names, split by INI_SUBSECTION_DELIMETER into components
+  struct SectionNode {
+    typedef FlatMap<std::string, std::unique_ptr<SectionNode>> ChildMap;
+    SectionNode*                                               parent  = NULL;  // NULL for the root of the tree
+    Section*                                                   section = NULL;  // section with the name of the node, if any
+    std::string                                                name;            // last component of the name
+    ChildMap                                                   children;
+  };
+
   /**
    * One section of the ini-file
    * This can be created by INIFile class only
    **/
   class Section {
     friend class File;
-    typedef std::map<std::string, Value>        EntryMap;
+    friend class SectionStore;
+    typedef FlatMap<std::string, Value>         EntryMap;
     typedef std::pair<std::string, Value>       EntryPair;
-    typedef std::map<std::string, std::string>  CommentMap;
+    typedef FlatMap<std::string, std::string>   CommentMap;
     typedef std::pair<std::string, std::string> CommentPair;
     /*-----------------------------------------------------------------------------------------------------------/
     / General functions & iterators
@@ -816,38 +1497,254 @@ namespace INI {
     / Parent & child parsing
     /-----------------------------------------------------------------------------------------------------------*/
   public:
-    Section*      FindParent() const;
-    Section*      GetParent();
-    Section*      FindSubSection(const std::string& name) const;
-    Section*      GetSubSection(const std::string& name);
-    SectionVector FindSubSections() const;
+    /// Non-const functions find and create sections through the file, that modifies this section, so that copies of the
+    /// file stay unchanged
+    const Section*     FindParent() const;
+    Section*           FindParent();
+    Section*           GetParent();
+    const Section*     FindSubSection(const std::string& name) const;
+    Section*           FindSubSection(const std::string& name);
+    Section*           GetSubSection(const std::string& name);
+    ConstSectionVector FindSubSections() const;
+    SectionVector      FindSubSections();
     /*-----------------------------------------------------------------------------------------------------------/
     / Internal contents
     /-----------------------------------------------------------------------------------------------------------*/
   private:
     /// Only INI::File can create sections
-    Section(File* file, const std::string& name, const std::string& comment = std::string()) :
-        _file(file), _name(name), _comment(comment) {}
-    /// Class should be copied only by File class to properly handle _file
+    Section(const std::string& name, const std::string& comment = std::string()) :
+        _store(NULL), _node(NULL), _name(name), _comment(comment), _lazy(false) {}
+    /// Class should be copied only by SectionStore class to properly handle _store and _node
     Section(const Section& cp) :
-        _file(cp._file), _name(cp._name), _comment(cp._comment), _entries(cp._entries), _comments(cp._comments) {}
-    File*       _file;      // file, this section is associated with
-    std::string _name;      // name of the section
-    std::string _comment;   // comment to the section
-    EntryMap    _entries;   // all entries in the section
-    CommentMap  _comments;  // all comments, associated with values in the section
+        _store(NULL), _node(NULL), _name(cp._name), _comment(cp._comment), _entries(cp._entries), _comments(cp._comments),
+        _pending(cp._pending), _lazy(cp._lazy.load()) {}
+    /// Add comment and values of @param sect, parsed from the text following this section, to this section
+    void Merge(Section& sect) {
+      if (!sect._comment.empty()) {
+        if (!_comment.empty())
+          _comment += '\n' + sect._comment;
+        else
+          _comment = sect._comment;
+      }
+      for (values_iter vit = sect.ValuesBegin(); vit != sect.ValuesEnd(); ++vit) _entries[vit->first] = std::move(vit->second);
+      for (CommentMap::iterator cit = sect._comments.begin(); cit != sect._comments.end(); ++cit)
+        _comments[cit->first] = cit->second;
+    }
+    SectionStore*          _store;     // store of the file, this section is associated with
+    SectionNode*           _node;      // node of the section in the tree of sections of the store
+    std::string            _name;      // name of the section
+    std::string            _comment;   // comment to the section
+    EntryMap               _entries;   // all entries in the section
+    CommentMap             _comments;  // all comments, associated with values in the section
+    // parts of lazily loaded text with contents of the section, that are not parsed yet
+    std::vector<TextChunk> _pending;
+    // set while there are pending chunks, checked before locking the store
+    std::atomic<bool>      _lazy;
+  };
+
+  /**
+   * Sections of the file together with the tree index of their names
+   * Copies of a file share one store until one of them is modified. Lazily loaded sections are parsed on the first
+   * access under the lock of the store, so that concurrent readers of the store are safe
+   **/
+  class SectionStore {
+    friend class File;
+    friend class Section;
+
+  public:
+    typedef FlatMap<std::string, Section*>   SectionMap;
+    typedef std::pair<std::string, Section*> SectionPair;
+
+    SectionStore() {}
+    SectionStore(const SectionStore&)            = delete;
+    SectionStore& operator=(const SectionStore&) = delete;
+    ~SectionStore() { Clear(); }
+
+    /// Copy of all sections, lazily loaded sections stay not parsed and refer to the same text
+    std::shared_ptr<SectionStore> Clone() const {
+      std::shared_ptr<SectionStore> store = std::make_shared<SectionStore>();
+      std::lock_guard<std::mutex>   lock(_mutex);
+      for (SectionMap::const_iterator it = _sections.begin(); it != _sections.end(); ++it)
+        store->Insert(new Section(*it->second));
+      store->_lazy_text  = _lazy_text;
+      store->_lazy_flags = _lazy_flags;
+      return store;
+    }
+    /// Find section with @param name
+    /// @return pointer to existing section or NULL
+    Section* Find(const std::string& name) const {
+      SectionMap::const_iterator it = _sections.find(name);
+      if (it == _sections.end()) return NULL;
+      Materialize(it->second);
+      return it->second;
+    }
+    /// Find section with @param name, section is created if it does not exist
+    Section* Get(const std::string& name) {
+      SectionMap::iterator it = _sections.find(name);
+      if (it == _sections.end()) return Insert(new Section(name));
+      Materialize(it->second);
+      return it->second;
+    }
+    /// Delete section with @param name
+    void Delete(const std::string& name) {
+      SectionMap::iterator it = _sections.find(name);
+      if (it == _sections.end()) return;
+      SectionNode* node = it->second->_node;
+      node->section     = NULL;
+      // nodes left without sections and children are removed up to the root
+      while (node->parent && !node->section && node->children.empty()) {
+        SectionNode* parent = node->parent;
+        parent->children.erase(parent->children.find(node->name));
+        node = parent;
+      }
+      delete it->second;
+      _sections.erase(it);
+    }
+    /// Delete all sections
+    void Clear() {
+      for (SectionMap::iterator it = _sections.begin(); it != _sections.end(); ++it) delete (it->second);
+      _sections.clear();
+      _root.children.clear();
+      _lazy_text.reset();
+    }
+    /// Find subsection of @param sect with @param name relative to the name of the section
+    Section* FindSubSection(const Section* sect, const std::string& name) const {
+      SectionNode* node = FindNode(sect->_node, name, false);
+      if (!node || !node->section) return NULL;
+      Materialize(node->section);
+      return node->section;
+    }
+    /// Find subsection of @param sect with @param name, subsection is created if it does not exist
+    Section* GetSubSection(const Section* sect, const std::string& name) {
+      return Get(sect->FullName() + INI_SUBSECTION_DELIMETER + name);
+    }
+    /// Find parent of @param sect, parent of top-level sections is the default section with empty name
+    Section* FindParent(const Section* sect) const {
+      Section* parent = ParentNode(sect)->section;
+      if (parent) Materialize(parent);
+      return parent;
+    }
+    /// Find parent of @param sect, parent is created if it does not exist
+    Section* GetParent(const Section* sect) {
+      Section* parent = ParentNode(sect)->section;
+      if (!parent) {
+        size_t pos = sect->FullName().rfind(INI_SUBSECTION_DELIMETER);
+        return Get(pos == std::string::npos ? std::string() : sect->FullName().substr(0, pos));
+      }
+      Materialize(parent);
+      return parent;
+    }
+    /// Find all subsections of @param sect (at any depth), sorted by name
+    /// Top-level sections are children of the default section, so all other sections are subsections of it
+    SectionVector FindSubSections(const Section* sect) const {
+      SectionVector ret;
+      if (sect->_node->parent == &_root && sect->_name.empty()) {
+        CollectSections(&_root, ret);
+        ret.erase(std::remove(ret.begin(), ret.end(), sect), ret.end());
+      } else {
+        CollectSections(sect->_node, ret);
+      }
+      std::sort(ret.begin(), ret.end(), [](const Section* a, const Section* b) { return a->FullName() < b->FullName(); });
+      return ret;
+    }
+    /// Find sections, which are not children of any other sections
+    SectionVector FindTopLevelSections() const {
+      SectionVector ret;
+      for (SectionNode::ChildMap::const_iterator it = _root.children.begin(); it != _root.children.end(); ++it) {
+        if (!it->second->section) continue;
+        Materialize(it->second->section);
+        ret.push_back(it->second->section);
+      }
+      return ret;
+    }
+    /// Parse pending chunks of lazily loaded section @param sect
+    void Materialize(Section* sect) const;
+    /// Parse all lazily loaded sections
+    void MaterializeAll() const {
+      for (SectionMap::const_iterator it = _sections.begin(); it != _sections.end(); ++it) Materialize(it->second);
+    }
+
+  private:
+    /// Add new section @param sect to the map and to the tree of sections
+    Section* Insert(Section* sect) {
+      sect->_store = this;
+      sect->_node  = FindNode(&_root, sect->_name, true);
+      _sections.insert(SectionPair(sect->_name, sect));
+      sect->_node->section = sect;
+      return sect;
+    }
+    /// Find node of the section @param name relative to @param node
+    /// Missing nodes are created if @param create is set, otherwise NULL is returned
+    static SectionNode* FindNode(SectionNode* node, const std::string& name, bool create) {
+      size_t begin = 0;
+      while (node) {
+        size_t                          end = name.find(INI_SUBSECTION_DELIMETER, begin);
+        std::string                     key = name.substr(begin, end - begin);
+        SectionNode::ChildMap::iterator it  = node->children.find(key);
+        if (it != node->children.end()) {
+          node = it->second.get();
+        } else if (create) {
+          std::unique_ptr<SectionNode>& child = node->children[key];
+          child.reset(new SectionNode());
+          child->parent = node;
+          child->name   = key;
+          node          = child.get();
+        } else {
+          node = NULL;
+        }
+        if (end == std::string::npos) break;
+        begin = end + 1;
+      }
+      return node;
+    }
+    /// Node of the parent of @param sect, top-level sections are children of the default section
+    SectionNode* ParentNode(const Section* sect) const {
+      SectionNode* parent = sect->_node->parent;
+      if (parent == &_root) {
+        SectionNode::ChildMap::const_iterator it = _root.children.find(std::string());
+        if (it != _root.children.end()) parent = it->second.get();
+      }
+      return parent;
+    }
+    /// Append sections of all descendants of @param node to @param ret
+    void CollectSections(const SectionNode* node, SectionVector& ret) const {
+      for (SectionNode::ChildMap::const_iterator it = node->children.begin(); it != node->children.end(); ++it) {
+        if (it->second->section) {
+          Materialize(it->second->section);
+          ret.push_back(it->second->section);
+        }
+        CollectSections(it->second.get(), ret);
+      }
+    }
+
+    // All sections (including subsections) in one map
+    SectionMap                        _sections;
+    // Tree of all sections by components of their names, root node has no section
+    SectionNode                       _root;
+    // text of the lazily loaded file and INI_LOAD_* flags it was loaded with, pending chunks of sections refer to it
+    std::shared_ptr<const TextBuffer> _lazy_text;
+    int                               _lazy_flags = INI_LOAD_DEFAULT;
+    // guards parsing of lazily loaded sections
+    mutable std::mutex                _mutex;
+    // file, that has the store for itself and modifies it, NULL if the file has not been modified since it was copied
+    File*                             _file = NULL;
   };
 
   /**
    * Main class of the parser
    * Provides way to load and save ini-files, as well as
    * setting specific values in them
+   * Copies of the file share their sections until one of them is modified through a non-const function.
+   * Const functions can be called from several threads at once and only give const sections. Sections can be modified
+   * only through pointers obtained from non-const functions, while the file is not copied
    **/
   class File {
+    friend class SectionStore;
+
   public:
     /// Sections stores all values and comments inside them
-    typedef std::map<std::string, Section*>  SectionMap;
-    typedef std::pair<std::string, Section*> SectionPair;
+    typedef SectionStore::SectionMap  SectionMap;
+    typedef SectionStore::SectionPair SectionPair;
     typedef SectionMap::iterator             sections_iter;
     typedef SectionMap::const_iterator       const_sections_iter;
     /// Result of previous parse operation
@@ -869,6 +1766,7 @@ namespace INI {
         if (error_code == INI_ERR_PARSING_ERROR)
           return std::string("Parse error in file ") + file_name + " on line #" + t_to_string(error_line) + ": \"" + error_line +
                  "\"";
+        if (error_code == INI_ERR_INCLUDE_CYCLE) return std::string("Cyclic inclusion of file ") + file_name + "!";
         return "Unknown error!";
       }
       int         error_code;      // code of the error. 0 if no error
@@ -879,44 +1777,58 @@ namespace INI {
     };
 
   public:
-    File() {}
-    File(const std::string& fname) { Load(fname); }
-    File(const File& lf) { CopyFrom(lf); }
+    File() : _store(std::make_shared<SectionStore>()) {}
+    File(const std::string& fname) : _store(std::make_shared<SectionStore>()) { Load(fname); }
+    /// Copy shares sections with @param lf until one of the files is modified
+    File(const File& lf) : _store(lf._store), _result(lf._result), _flags(lf._flags) {}
     File& operator=(const File& lf) {
-      Unload();
-      CopyFrom(lf);
+      if (this == &lf) return *this;
+      Release();
+      _store  = lf._store;
+      _result = lf._result;
+      _flags  = lf._flags;
       return *this;
     }
+    /// Make this file an independent copy of @param lf
     void CopyFrom(const File& lf) {
-      for (SectionMap::const_iterator it = lf._sections.begin(); it != lf._sections.end(); it++) {
-        Section* sect = new Section(*it->second);
-        sect->_file   = this;
-        _sections.insert(SectionPair(it->first, sect));
-      }
+      Release();
+      _store  = lf._store->Clone();
       _result = lf._result;
+      _flags  = lf._flags;
     }
-    virtual ~File() { Unload(); }
+    virtual ~File() { Release(); }
     /*---------------------------------------------------------------------------------------------------------------/
     / Section & values manipulations
     /---------------------------------------------------------------------------------------------------------------*/
   public:
     /// A way to iterate through all sections
     /// Section pointer can be accesed as SectionMap::iterator::second, section name - as ::first
-    size_t              SectionsSize() const { return _sections.size(); }
-    sections_iter       SectionsBegin() { return _sections.begin(); }
-    const_sections_iter SectionsBegin() const { return _sections.begin(); }
-    sections_iter       SectionsEnd() { return _sections.end(); }
-    const_sections_iter SectionsEnd() const { return _sections.end(); }
+    /// Lazily loaded sections are parsed before iteration
+    size_t              SectionsSize() const { return _store->_sections.size(); }
+    sections_iter       SectionsBegin() {
+      Detach();
+      _store->MaterializeAll();
+      return _store->_sections.begin();
+    }
+    const_sections_iter SectionsBegin() const {
+      _store->MaterializeAll();
+      return _store->_sections.begin();
+    }
+    sections_iter       SectionsEnd() {
+      Detach();
+      return _store->_sections.end();
+    }
+    const_sections_iter SectionsEnd() const { return _store->_sections.end(); }
 
     /// Get value from the file
     /// Use INI_SECTION_VALUE_DELIMETER to separate section name from value name
-    Value               GetValue(const std::string& name, const Value& def_val = Value()) {
+    Value               GetValue(const std::string& name, const Value& def_val = Value()) const {
       size_t      pos = name.rfind(INI_SECTION_VALUE_DELIMETER);
       std::string nm;
       if (pos != std::string::npos) nm = name.substr(0, pos);
-      SectionMap::iterator it = _sections.find(nm);
-      if (it == _sections.end()) return def_val;
-      return it->second->GetValue(name.substr(pos + 1), def_val);
+      const Section* sect = _store->Find(nm);
+      if (!sect) return def_val;
+      return sect->GetValue(name.substr(pos + 1), def_val);
     }
 
     /// Set value to the file
@@ -938,31 +1850,34 @@ namespace INI {
 
     /// Returns pointer to section with specified name
     /// If section does not exists - creates it
-    Section* GetSection(const std::string& name) {
-      SectionMap::iterator it = _sections.find(name);
-      if (it != _sections.end()) return it->second;
-      Section* sc = new Section(this, name);
-      _sections.insert(SectionPair(name, sc));
-      return sc;
+    Section*       GetSection(const std::string& name) {
+      Detach();
+      return _store->Get(name);
     }
 
     /// Find existing section by name
     /// @return pointer to existing section or NULL
-    Section* FindSection(const std::string& name) const {
-      SectionMap::const_iterator it = _sections.find(name);
-      if (it == _sections.end()) return NULL;
-      return it->second;
+    Section*       FindSection(const std::string& name) {
+      Detach();
+      return _store->Find(name);
     }
+    const Section* FindSection(const std::string& name) const { return _store->Find(name); }
 
     /// Deletes section with specified name
-    void DeleteSection(const std::string& name) {
-      SectionMap::iterator it = _sections.find(name);
-      if (it != _sections.end()) _sections.erase(it);
+    void           DeleteSection(const std::string& name) {
+      Detach();
+      _store->Delete(name);
     }
 
     /// Get subsection of specified section with specified name
-    Section* FindSubSection(const Section* sect, const std::string& name) const {
-      return FindSection(sect->FullName() + INI_SUBSECTION_DELIMETER + name);
+    Section*       FindSubSection(const Section* sect, const std::string& name) {
+      Detach();
+      const Section* own = OwnSection(sect);
+      return own ? _store->FindSubSection(own, name) : NULL;
+    }
+    const Section* FindSubSection(const Section* sect, const std::string& name) const {
+      const Section* own = OwnSection(sect);
+      return own ? _store->FindSubSection(own, name) : NULL;
     }
 
     /// If subsection does not exists, creates it
@@ -971,36 +1886,45 @@ namespace INI {
     }
 
     /// Get parent section of the specified section
-    Section* FindParentSection(const Section* sect) const {
-      size_t      pos = sect->FullName().rfind(INI_SUBSECTION_DELIMETER);
-      std::string nm;
-      if (pos != std::string::npos) nm = sect->FullName().substr(0, pos);
-      return FindSection(nm);
+    /// Parent of top-level sections is the default section with empty name
+    Section*       FindParentSection(const Section* sect) {
+      Detach();
+      const Section* own = OwnSection(sect);
+      return own ? _store->FindParent(own) : NULL;
+    }
+    const Section* FindParentSection(const Section* sect) const {
+      const Section* own = OwnSection(sect);
+      return own ? _store->FindParent(own) : NULL;
     }
     /// Get parent section (created if needed)
     Section* GetParentSection(const Section* sect) {
-      size_t      pos = sect->FullName().rfind(INI_SUBSECTION_DELIMETER);
-      std::string nm;
-      if (pos != std::string::npos) nm = sect->FullName().substr(0, pos);
-      return GetSection(nm);
-    }
-    /// Find subsections of the specified section
-    SectionVector FindSubSections(const Section* sect) const {
-      SectionVector ret;
-      if (sect->_file != this) return ret;
-      for (SectionMap::const_iterator it = _sections.begin(); it != _sections.end(); ++it) {
-        if (it->second == sect) continue;
-        if (it->first.find(sect->FullName() + INI_SUBSECTION_DELIMETER) != std::string::npos) ret.push_back(it->second);
-      }
-      return ret;
+      Detach();
+      const Section* own = OwnSection(sect);
+      if (own) return _store->GetParent(own);
+      size_t pos = sect->FullName().rfind(INI_SUBSECTION_DELIMETER);
+      return GetSection(pos == std::string::npos ? std::string() : sect->FullName().substr(0, pos));
+    }
+    /// Find all subsections of the specified section (at any depth), sorted by name
+    /// All other sections are subsections of the default section with empty name
+    SectionVector      FindSubSections(const Section* sect) {
+      Detach();
+      const Section* own = OwnSection(sect);
+      return own ? _store->FindSubSections(own) : SectionVector();
+    }
+    ConstSectionVector FindSubSections(const Section* sect) const {
+      const Section* own = OwnSection(sect);
+      if (!own) return ConstSectionVector();
+      SectionVector subs = _store->FindSubSections(own);
+      return ConstSectionVector(subs.begin(), subs.end());
     }
     // Get top-level sections (not child of any other sections)
-    SectionVector GetTopLevelSections() const {
-      SectionVector ret;
-      for (SectionMap::const_iterator it = _sections.begin(); it != _sections.end(); ++it) {
-        if (it->first.find(INI_SUBSECTION_DELIMETER) == std::string::npos) ret.push_back(it->second);
-      }
-      return ret;
+    SectionVector      GetTopLevelSections() {
+      Detach();
+      return _store->FindTopLevelSections();
+    }
+    ConstSectionVector GetTopLevelSections() const {
+      SectionVector sections = _store->FindTopLevelSections();
+      return ConstSectionVector(sections.begin(), sections.end());
     }
     /*---------------------------------------------------------------------------------------------------------------/
     / Load & Save functions
@@ -1011,25 +1935,52 @@ namespace INI {
     /// Set @param rpath to be used as relative path when searching for inclusions in files
     /// @return 1 if load succeeds, 0 if not
     /// in case load was not succesfull you can access extended information by calling ParseResult()
-    int Load(std::istream& stream, bool unload_prev = false, const std::string& rpath = std::string()) {
-      if (unload_prev) DeleteSections(_sections);
-      return ParseStream(stream, "", rpath, _sections);
+    /// Set @param flags to combination of INI_LOAD_* flags
+    int Load(std::istream& stream, bool unload_prev = false, const std::string& rpath = std::string(),
+             int flags = INI_LOAD_DEFAULT) {
+      LoadTarget(unload_prev, std::string());
+      _flags = flags;
+      std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+      // Clears eof flag for future usage of stream
+      stream.clear();
+      return LoadBuffer(TextBuffer::FromString(std::move(text)), rpath);
+    }
+    /// Load ini from @param text in memory, the text is parsed in place without copying it
+    /// Values (and sections with INI_LOAD_LAZY) refer to the text, so it has to stay valid as long as the file and values
+    /// taken from it are used (Value::Detach() makes own copy of a value)
+    /// Other parameters are the same as for loading from stream
+    int LoadText(std::string_view text, bool unload_prev = false, const std::string& rpath = std::string(),
+                 int flags = INI_LOAD_DEFAULT) {
+      LoadTarget(unload_prev, std::string());
+      _flags = flags;
+      return LoadBuffer(TextBuffer::FromView(text), rpath);
+    }
+    /// Load ini from @param size characters starting at @param data, see LoadText(std::string_view)
+    int LoadText(const char* data, size_t size, bool unload_prev = false, const std::string& rpath = std::string(),
+                 int flags = INI_LOAD_DEFAULT) {
+      return LoadText(std::string_view(data, size), unload_prev, rpath, flags);
     }
     /// Load ini from file in system
+    /// Whole file is read (or memory-mapped with INI_LOAD_MMAP) at once and values refer to its text without copying
+    /// With INI_LOAD_LAZY sections are only indexed and each of them is parsed on the first access
+    /// With INI_LOAD_PARALLEL large files are parsed on several threads
     /// Set @param unload_prev to false for not unloading any stuff currently in memory before loading
-    int Load(const std::string& fname, bool unload_prev = true) {
+    /// Set @param flags to combination of INI_LOAD_* flags
+    int Load(const std::string& fname, bool unload_prev = true, int flags = INI_LOAD_DEFAULT) {
       _result.file_name = fname;
       normalize_path(_result.file_name);
-      std::ifstream file(_result.file_name.c_str(), std::ios::in);
-      if (!file.is_open()) {
+      _flags                                   = flags;
+      std::shared_ptr<const TextBuffer> buffer = OpenFile(_result.file_name, flags);
+      if (!buffer) {
         _result.Set(INI_ERR_INVALID_FILENAME);
         return 0;
       }
-      return Load(file, unload_prev, file_path(_result.file_name));
+      LoadTarget(unload_prev, _result.file_name);
+      return LoadBuffer(buffer, file_path(_result.file_name));
     }
 
     /// Save ini file to stream
-    void Save(std::ostream& stream) const { SaveStream(stream, _sections); }
+    void Save(std::ostream& stream) const { SaveStream(stream, _store->_sections); }
 
     /// Save ini file to file
     int  Save(const std::string& fname) {
@@ -1040,12 +1991,151 @@ namespace INI {
         _result.Set(INI_ERR_INVALID_FILENAME);
         return 0;
       }
-      SaveStream(file, _sections);
+      SaveStream(file, _store->_sections);
+      return 1;
+    }
+
+    /// Update file @param fname on disk to contain the values of this file, keeping the rest of its text
+    /// Changed values are replaced in place, new values are added after the last occurrence of their section (new
+    /// sections are appended to the end of the file), lines with values missing in this file are removed.
+    /// Comments, order and formatting of other lines are preserved. Names in the file are compared in lower case, if this
+    /// file was loaded with INI_LOAD_FOLD_CASE. The new text is written to a temporary file, that replaces the file, so
+    /// that memory-mapped copies of the old text stay valid. Files with inclusions are written with Save(fname)
+    /// @return 1 if update succeeds, 0 if not
+    int Patch(const std::string& fname) {
+      _result.file_name = fname;
+      normalize_path(_result.file_name);
+      std::shared_ptr<const TextBuffer> buffer = TextBuffer::ReadFile(_result.file_name);
+      if (!buffer) {
+        _result.Set(INI_ERR_INVALID_FILENAME);
+        return 0;
+      }
+      std::string_view text = buffer->View();
+      // Find positions of sections and values in the text
+      std::map<std::string, size_t>                                  section_ends;
+      std::map<std::pair<std::string, std::string>, PatchPosition> positions;
+      std::string                                                    section;
+      LineReader                                                     reader(text);
+      std::string_view                                               line;
+      bool                                                           in_text;
+      section_ends[""] = 0;
+      while (reader.Next(line, in_text)) {
+        if (line.empty()) continue;
+        std::string_view section_key, value, comment;
+        LineType         lt = ParseLine(line, section_key, section_key, value, comment);
+        if (lt == LEKSYSINI_ERROR) {
+          _result.Set(INI_ERR_PARSING_ERROR, reader.LineNumber(), std::string(line));
+          return 0;
+        }
+        if (lt == LEKSYSINI_COMMENT) {
+          if (comment.substr(0, strlen(INI_INCLUDE_SEQ)) == INI_INCLUDE_SEQ) return Save(fname);
+          continue;
+        }
+        TextChunk   lines = {reader.Offset(), reader.End(), reader.FirstLineNumber()};
+        std::string name(section_key);
+        if (_flags & INI_LOAD_FOLD_CASE) string_to_lower(name);
+        if (lt == LEKSYSINI_SECTION) section = name;
+        section_ends[section] = lines.end;
+        if (lt != LEKSYSINI_ENTRY) continue;
+        PatchPosition& pos = positions[std::make_pair(section, name)];
+        pos.lines.push_back(lines);
+        pos.old_value    = std::string(value);
+        // joined and empty values are replaced together with their lines
+        pos.replace_line = !in_text || value.empty();
+        if (!pos.replace_line) {
+          pos.value.begin = value.data() - text.data();
+          pos.value.end   = pos.value.begin + value.size();
+        }
+      }
+      // Collect modifications of the text
+      std::vector<PatchEdit> edits;
+      // new sections, each is preceded by empty line
+      std::string            appended;
+      _store->MaterializeAll();
+      for (SectionMap::const_iterator it = _store->_sections.begin(); it != _store->_sections.end(); ++it) {
+        const Section*                                sect = it->second;
+        std::map<std::string, size_t>::const_iterator end  = section_ends.find(it->first);
+        std::string                                   new_section;
+        for (Section::const_values_iter vit = sect->ValuesBegin(); vit != sect->ValuesEnd(); ++vit) {
+          std::string line_text;
+          AppendEntry(line_text, vit->first, vit->second, sect->GetComment(vit->first));
+          std::map<std::pair<std::string, std::string>, PatchPosition>::iterator pos =
+              positions.find(std::make_pair(it->first, vit->first));
+          if (pos == positions.end()) {
+            if (end != section_ends.end())
+              edits.push_back(PatchEdit{end->second, end->second, line_text});
+            else
+              new_section += line_text;
+            continue;
+          }
+          if (pos->second.old_value != vit->second.View()) {
+            if (pos->second.replace_line)
+              edits.push_back(PatchEdit{pos->second.lines.back().begin, pos->second.lines.back().end, line_text});
+            else
+              edits.push_back(PatchEdit{pos->second.value.begin, pos->second.value.end, vit->second.AsString()});
+          }
+          positions.erase(pos);
+        }
+        if (new_section.empty()) continue;
+        appended += '\n';
+        if (!sect->Comment().empty()) AppendComment(appended, sect->Comment());
+        AppendSectionName(appended, it->first);
+        appended += new_section;
+      }
+      // Values, which are not in this file anymore
+      for (std::map<std::pair<std::string, std::string>, PatchPosition>::iterator pos = positions.begin();
+           pos != positions.end(); ++pos) {
+        for (size_t i = 0; i < pos->second.lines.size(); ++i)
+          edits.push_back(PatchEdit{pos->second.lines[i].begin, pos->second.lines[i].end, std::string()});
+      }
+      // New sections are added before unfinished multiline string, otherwise they would be joined to it
+      if (!appended.empty()) {
+        size_t text_end = std::min(reader.Unfinished(), text.size());
+        edits.push_back(PatchEdit{text_end, text_end, appended.substr(text_end == 0 ? 1 : 0)});
+      }
+      if (edits.empty()) return 1;
+      // Apply modifications to the text
+      std::stable_sort(edits.begin(), edits.end(), [](const PatchEdit& a, const PatchEdit& b) { return a.begin < b.begin; });
+      size_t      next = 0;
+      std::string patched;
+      patched.reserve(text.size());
+      for (size_t i = 0; i < edits.size(); ++i) {
+        patched.append(text.substr(next, edits[i].begin - next));
+        // text may have no line break at the end
+        if (edits[i].begin == text.size() && !edits[i].text.empty() && !text.empty() && text.back() != '\n' &&
+            (patched.empty() || patched.back() != '\n'))
+          patched += '\n';
+        patched += edits[i].text;
+        next = edits[i].end;
+      }
+      patched.append(text.substr(next));
+      // File is replaced instead of being modified in place, values and other processes may refer to its mapped text
+      std::string tmp_name = _result.file_name + ".tmp";
+#ifdef INI_HAS_MMAP
+      tmp_name += std::to_string(getpid());
+#endif
+      {
+        std::ofstream file(tmp_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(patched.data(), static_cast<std::streamsize>(patched.size()));
+        if (!file) {
+          file.close();
+          std::remove(tmp_name.c_str());
+          _result.Set(INI_ERR_INVALID_FILENAME);
+          return 0;
+        }
+      }
+      std::error_code ec;
+      std::filesystem::permissions(tmp_name, std::filesystem::status(_result.file_name, ec).permissions(), ec);
+      if (std::rename(tmp_name.c_str(), _result.file_name.c_str()) != 0) {
+        std::remove(tmp_name.c_str());
+        _result.Set(INI_ERR_INVALID_FILENAME);
+        return 0;
+      }
       return 1;
     }
 
     /// Save only one section to specifed stream
-    void Save(std::ostream& stream, const Section* sect) const {
+    static void Save(std::ostream& stream, const Section* sect) {
       SectionMap mp;
       mp.insert(SectionPair(sect->FullName(), const_cast<Section*>(sect)));
       SaveStream(stream, mp);
@@ -1054,19 +2144,49 @@ namespace INI {
     /// Adds comment line to provided stream
     /// For it to be not associated with anything you should add newline after it
     static void AddCommentToStream(std::ostream& stream, const std::string& str) {
-      std::vector<std::string> ar = split_string(str, "\n");
-      for (size_t i = 0; i < ar.size(); i++) stream << INI_COMMENT_CHARS[0] << ar.at(i) << std::endl;
+      std::string out;
+      AppendComment(out, str);
+      stream.write(out.data(), out.size());
     }
 
     /// Adds inclusion line to stream
     static void AddIncludeToStream(std::ostream& stream, const std::string& path) {
-      stream << INI_COMMENT_CHARS[0] << INI_INCLUDE_SEQ << path << std::endl;
+      stream << INI_COMMENT_CHARS[0] << INI_INCLUDE_SEQ << path << '\n';
     }
 
     /// Unload memory
-    void           Unload() { DeleteSections(_sections); }
+    /// Sections are released when they are not shared with copies of the file anymore
+    void           Unload() { _store = std::make_shared<SectionStore>(); }
     /// Return last operation result
     const PResult& LastResult() { return _result; }
+    /// Paths of the files included by the last load operation
+    std::vector<std::string> IncludedFiles() const {
+      std::vector<std::string> paths;
+      for (IncludeMap::const_iterator it = _includes.begin(); it != _includes.end(); ++it) paths.push_back(it->first);
+      return paths;
+    }
+    /// Drop included files cached by all files of the process
+    static void    ClearIncludeCache() {
+      IncludeCache&               cache = SharedIncludes();
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      cache.files.clear();
+    }
+    /// Keep at most @param files included files in the cache shared by all files of the process (0 disables the cache)
+    /// @return previous limit
+    static size_t SetIncludeCacheLimit(size_t files) {
+      IncludeCache&               cache = SharedIncludes();
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      size_t                      prev = cache.limit;
+      cache.limit                      = files;
+      EvictIncludes(cache);
+      return prev;
+    }
+    /// Number of included files in the cache shared by all files of the process
+    static size_t IncludeCacheSize() {
+      IncludeCache&               cache = SharedIncludes();
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      return cache.files.size();
+    }
     /*---------------------------------------------------------------------------------------------------------------/
     / Parsing & Saving internals
     /---------------------------------------------------------------------------------------------------------------*/
@@ -1076,6 +2196,7 @@ namespace INI {
     /**
      * Parse input line
      * Line must be concatenated (if needed) and trimmed before passing to this function
+     * Returned parts refer to the text of @param input_line
      * @param input_line - Line to parse
      * @param section - will contain section name in case SECTION return
      * @param key - will contain key in case ENTRY return
@@ -1083,19 +2204,15 @@ namespace INI {
      * @param comment - will contain comment in case of return != EMPTY and != ERROR
      * @return type of the parsed line
      **/
-    LineType ParseLine(const std::string& input_line, std::string& section, std::string& key, std::string& value,
-                       std::string& comment) const {
+    LineType ParseLine(std::string_view input_line, std::string_view& section, std::string_view& key, std::string_view& value,
+                       std::string_view& comment) const {
       LineType ret      = LEKSYSINI_EMPTY;
       size_t   last_pos = input_line.npos;
       if (input_line.empty()) return ret;
       // comment parsing
       if (char_is_one_of(input_line.at(0), INI_COMMENT_CHARS)) {
         ret     = LEKSYSINI_COMMENT;
-        // Can't do it that way, cause of 'initialization of non-const reference of type from a temporary of type'
-        // stupid GCC rule
-        // comment = trim(input_line.substr(1));
-        comment = input_line.substr(1);
-        trim(comment);
+        comment = trim_view(input_line.substr(1));
         return ret;
       }
       // section parsing
@@ -1103,8 +2220,7 @@ namespace INI {
         last_pos = input_line.find_first_of(INI_SECTION_CLOSE_CHARS);
         if (last_pos == input_line.npos) return LEKSYSINI_ERROR;
         ret     = LEKSYSINI_SECTION;
-        section = input_line.substr(1, last_pos - 1);
-        trim(section);
+        section = trim_view(input_line.substr(1, last_pos - 1));
         last_pos++;
       }
       // key-value pair parsing
@@ -1112,79 +2228,333 @@ namespace INI {
         size_t pos = input_line.find_first_of(INI_NAME_VALUE_SEP_CHARS);
         // not section, not comment, not empty - error
         if (pos == input_line.npos || pos == input_line.size() - 1) return LEKSYSINI_ERROR;
-        ret = LEKSYSINI_ENTRY;
-        key = input_line.substr(0, pos);
-        trim(key);
+        ret      = LEKSYSINI_ENTRY;
+        key      = trim_view(input_line.substr(0, pos));
         last_pos = input_line.find_first_of(INI_COMMENT_CHARS, pos + 1);
-        value    = input_line.substr(pos + 1, last_pos - pos - 1);
-        trim(value);
+        value    = trim_view(input_line.substr(pos + 1, last_pos - pos - 1));
         if (last_pos != input_line.npos) last_pos--;
       }
       // get associated comment
       last_pos = input_line.find_first_of(INI_COMMENT_CHARS, last_pos);
-      if (last_pos != input_line.npos) {
-        comment = input_line.substr(last_pos + 1);
-        trim(comment);
-      }
+      if (last_pos != input_line.npos) comment = trim_view(input_line.substr(last_pos + 1));
       return ret;
     }
 
-    /// Parse provided input stream to specified section map
+    /// Open file @param fname according to INI_LOAD_* @param flags
+    static std::shared_ptr<const TextBuffer> OpenFile(const std::string& fname, int flags) {
+      if (flags & INI_LOAD_MMAP) return TextBuffer::MapFile(fname);
+      return TextBuffer::ReadFile(fname);
+    }
+
+    /// Path of the file included with @param comment by the file in @param rpath directory
+    static std::string IncludePath(std::string_view comment, const std::string& rpath) {
+      std::string incname(trim_view(comment.substr(strlen(INI_INCLUDE_SEQ))));
+      normalize_path(incname);
+      if (path_is_relative(incname) && !rpath.empty()) incname = rpath + SYSTEM_PATH_DELIM + incname;
+      // the same file is always referred to by the same path in caches and in the stack of inclusions
+      return std::filesystem::path(incname).lexically_normal().string();
+    }
+    /// Open included file @param fpath, files are read once per load operation
+    std::shared_ptr<const TextBuffer> OpenInclude(const std::string& fpath) {
+      IncludeMap::iterator it = _includes.find(fpath);
+      if (it != _includes.end()) return it->second;
+      std::shared_ptr<const TextBuffer> file = ReadInclude(fpath, _flags);
+      if (file) _includes[fpath] = file;
+      return file;
+    }
+    /// Read included file @param fpath through the cache shared by all files of the process
+    /// Cached text is used while the file (its modification time, size and inode) stays the same. The state of the
+    /// file is taken from the descriptor the text is read from, so that it always describes the cached text
+    static std::shared_ptr<const TextBuffer> ReadInclude(const std::string& fpath, int flags) {
+      FileState state;
+#ifdef INI_HAS_MMAP
+      int fd = open(fpath.c_str(), O_RDONLY);
+      if (fd < 0) return NULL;
+      struct stat st;
+      if (fstat(fd, &st) != 0 || S_ISDIR(st.st_mode)) {
+        close(fd);
+        return NULL;
+      }
+      state.mtime      = static_cast<long long>(st.st_mtime);
+      state.mtime_nsec = static_cast<long long>(INI_STAT_MTIME_NSEC(st));
+      state.size       = static_cast<uintmax_t>(st.st_size);
+      state.inode      = static_cast<uintmax_t>(st.st_ino);
+#else
+      std::error_code ec;
+      state.mtime = static_cast<long long>(std::filesystem::last_write_time(fpath, ec).time_since_epoch().count());
+      if (ec) return NULL;
+      state.size = std::filesystem::file_size(fpath, ec);
+      if (ec) return NULL;
+#endif
+      IncludeCache& cache = SharedIncludes();
+      {
+        std::lock_guard<std::mutex>                    lock(cache.mutex);
+        std::map<std::string, CachedInclude>::iterator it = cache.files.find(fpath);
+        if (it != cache.files.end() && it->second.state == state) {
+          it->second.last_use = ++cache.uses;
+#ifdef INI_HAS_MMAP
+          close(fd);
+#endif
+          return it->second.buffer;
+        }
+      }
+#ifdef INI_HAS_MMAP
+      std::shared_ptr<const TextBuffer> file = TextBuffer::FromDescriptor(fd, st, flags & INI_LOAD_MMAP);
+#else
+      std::shared_ptr<const TextBuffer> file = OpenFile(fpath, flags);
+#endif
+      if (!file) return file;
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      if (cache.limit == 0) return file;
+      CachedInclude& cached = cache.files[fpath];
+      cached.buffer         = file;
+      cached.state          = state;
+      cached.last_use       = ++cache.uses;
+      EvictIncludes(cache);
+      return file;
+    }
+    /// Read files included by @param buffer from @param rpath directory and all files included by them in advance
+    /// Files of each level of inclusion are read on several threads, then the text is parsed using the read files
+    void PrefetchIncludes(const std::shared_ptr<const TextBuffer>& buffer, const std::string& rpath) {
+      std::vector<std::pair<std::shared_ptr<const TextBuffer>, std::string>> texts(1, std::make_pair(buffer, rpath));
+      while (!texts.empty()) {
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < texts.size(); ++i) {
+          if (texts[i].first->View().find(INI_INCLUDE_SEQ) == std::string_view::npos) continue;
+          LineReader       reader(texts[i].first->View());
+          std::string_view line;
+          bool             in_text;
+          while (reader.Next(line, in_text)) {
+            if (line.empty()) continue;
+            std::string_view section_key, value, comment;
+            if (ParseLine(line, section_key, section_key, value, comment) != LEKSYSINI_COMMENT) continue;
+            if (comment.substr(0, strlen(INI_INCLUDE_SEQ)) != INI_INCLUDE_SEQ) continue;
+            std::string fpath = IncludePath(comment, texts[i].second);
+            if (_includes.find(fpath) == _includes.end() && std::find(paths.begin(), paths.end(), fpath) == paths.end())
+              paths.push_back(fpath);
+          }
+        }
+        std::vector<std::shared_ptr<const TextBuffer>> files(paths.size());
+        std::vector<std::thread>                       workers;
+        std::atomic<size_t>                            next(0);
+        for (size_t t = 1; t < std::min<size_t>(std::thread::hardware_concurrency(), paths.size()); ++t) {
+          workers.emplace_back([&paths, &files, &next, this]() {
+            for (size_t i = next++; i < paths.size(); i = next++) files[i] = ReadInclude(paths[i], _flags);
+          });
+        }
+        for (size_t i = next++; i < paths.size(); i = next++) files[i] = ReadInclude(paths[i], _flags);
+        for (size_t t = 0; t < workers.size(); ++t) workers[t].join();
+        // files that failed to open are reported by parsing
+        texts.clear();
+        for (size_t i = 0; i < paths.size(); ++i) {
+          if (!files[i]) continue;
+          _includes[paths[i]] = files[i];
+          texts.push_back(std::make_pair(files[i], file_path(paths[i])));
+        }
+      }
+    }
+
+    /// Load text of @param buffer to the sections of the file
+    /// With INI_LOAD_LAZY only the text before the first section is parsed, other sections get chunks of the text to be
+    /// parsed on the first access. With INI_LOAD_PARALLEL chunks are parsed on several threads.
+    /// Text with inclusions is always parsed at once by a single thread
+    int LoadBuffer(const std::shared_ptr<const TextBuffer>& buffer, const std::string& rpath) {
+      std::vector<std::pair<std::string, TextChunk>> chunks;
+      size_t                                         prefix_end;
+      PrefetchIncludes(buffer, rpath);
+      if (!(_flags & (INI_LOAD_LAZY | INI_LOAD_PARALLEL)) || !IndexBuffer(buffer->View(), chunks, prefix_end))
+        return ParseBuffer(buffer, "", rpath);
+      if (!ParseBuffer(buffer, "", rpath, 0, prefix_end)) return 0;
+      if (!(_flags & INI_LOAD_LAZY)) return ParseParallel(buffer, chunks);
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        SectionMap::iterator it   = _store->_sections.find(chunks[i].first);
+        Section*             sect = it == _store->_sections.end() ? _store->Insert(new Section(chunks[i].first)) : it->second;
+        sect->_pending.push_back(chunks[i].second);
+        sect->_lazy = true;
+      }
+      _store->_lazy_text  = buffer;
+      _store->_lazy_flags = _flags;
+      return 1;
+    }
+
+    /// Quick scan of the @param text for lazy loading, no values are created
+    /// Every section line starts a chunk of the text, which also includes comments written right before the section line
+    /// @param chunks - will contain section names and chunks of the text in order of appearance
+    /// @param prefix_end - will contain the end of the text before the first chunk
+    /// @return false if the text can not be loaded lazily (it contains inclusions or errors)
+    bool IndexBuffer(std::string_view text, std::vector<std::pair<std::string, TextChunk>>& chunks, size_t& prefix_end) const {
+      LineReader       reader(text);
+      std::string_view line;
+      bool             in_text;
+      size_t           comment_begin = std::string_view::npos;
+      int              comment_line  = 0;
+      prefix_end                     = text.size();
+      while (reader.Next(line, in_text)) {
+        if (line.empty()) {
+          comment_begin = std::string_view::npos;
+          continue;
+        }
+        std::string_view section_key, value, comment;
+        LineType         lt = ParseLine(line, section_key, section_key, value, comment);
+        if (lt == LEKSYSINI_ERROR) return false;
+        if (lt == LEKSYSINI_COMMENT) {
+          if (comment.substr(0, strlen(INI_INCLUDE_SEQ)) == INI_INCLUDE_SEQ) return false;
+          if (comment_begin == std::string_view::npos) {
+            comment_begin = reader.Offset();
+            comment_line  = reader.FirstLineNumber();
+          }
+          continue;
+        }
+        if (lt == LEKSYSINI_SECTION) {
+          TextChunk chunk = {reader.Offset(), text.size(), reader.FirstLineNumber()};
+          if (comment_begin != std::string_view::npos) {
+            chunk.begin = comment_begin;
+            chunk.line  = comment_line;
+          }
+          if (chunks.empty())
+            prefix_end = chunk.begin;
+          else
+            chunks.back().second.end = chunk.begin;
+          std::string name(section_key);
+          if (_flags & INI_LOAD_FOLD_CASE) string_to_lower(name);
+          chunks.push_back(std::make_pair(std::move(name), chunk));
+        }
+        comment_begin = std::string_view::npos;
+      }
+      return true;
+    }
+
+    /// Parse @param chunks of the text of @param buffer on several threads
+    /// Chunks are split into contiguous groups, each group is parsed to its own section map,
+    /// then the maps are merged in order of the text, so the result is the same as of sequential parsing
+    int ParseParallel(const std::shared_ptr<const TextBuffer>& buffer,
+                      const std::vector<std::pair<std::string, TextChunk>>& chunks) {
+      if (chunks.empty()) return 1;
+      size_t text_size  = chunks.back().second.end - chunks.front().second.begin;
+      size_t nthreads   = std::min<size_t>(std::thread::hardware_concurrency(), text_size / INI_PARALLEL_CHUNK_SIZE);
+      size_t group_size = text_size / std::max<size_t>(nthreads, 1) + 1;
+      // contiguous groups of chunks of approximately equal size
+      std::vector<TextChunk> groups(1, chunks.front().second);
+      for (size_t i = 1; i < chunks.size(); ++i) {
+        if (chunks[i].second.begin - groups.back().begin < group_size) continue;
+        groups.back().end = chunks[i].second.begin;
+        groups.push_back(chunks[i].second);
+      }
+      groups.back().end = chunks.back().second.end;
+      if (groups.size() == 1)
+        return ParseBuffer(buffer, "", "", groups[0].begin, groups[0].end, groups[0].line);
+      // chunks have neither inclusions nor errors, so parts can be parsed independently
+      std::vector<File>        parts(groups.size());
+      std::vector<std::thread> workers;
+      for (size_t i = 0; i < parts.size(); ++i) parts[i]._flags = _flags;
+      for (size_t i = 1; i < groups.size(); ++i) {
+        workers.emplace_back([&parts, &groups, &buffer, i]() {
+          parts[i].ParseBuffer(buffer, "", "", groups[i].begin, groups[i].end, groups[i].line);
+        });
+      }
+      parts[0].ParseBuffer(buffer, "", "", groups[0].begin, groups[0].end, groups[0].line);
+      for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+      for (size_t i = 0; i < parts.size(); ++i) MergeSections(parts[i]);
+      return 1;
+    }
+
+    /// Move sections of @param part, parsed from the text following the already loaded one, to the file
+    /// Comments of repeated sections are merged and values are overridden the same way as by ParseBuffer
+    void MergeSections(File& part) {
+      SectionStore& store = *part._store;
+      for (SectionMap::iterator it = store._sections.begin(); it != store._sections.end(); ++it) {
+        Section*             sect = it->second;
+        SectionMap::iterator dst  = _store->_sections.find(it->first);
+        if (dst == _store->_sections.end()) {
+          _store->Insert(sect);
+          continue;
+        }
+        dst->second->Merge(*sect);
+        delete sect;
+      }
+      store._sections.clear();
+      store._root.children.clear();
+    }
+
+    /// Prepare sections for loading of another text: drop them if @param unload_prev is set, otherwise parse lazily loaded
+    /// ones and make own copy of them if they are shared with other files
+    /// @param fname - name of the loaded file (empty for streams), it is the bottom of the stack of inclusions
+    void LoadTarget(bool unload_prev, const std::string& fname) {
+      _includes.clear();
+      _include_stack.clear();
+      if (!fname.empty()) _include_stack.push_back(std::filesystem::path(fname).lexically_normal().string());
+      if (unload_prev) {
+        Unload();
+        return;
+      }
+      _store->MaterializeAll();
+      Detach();
+    }
+    /// Make own copy of sections shared with other files before modifying them
+    void Detach() {
+      if (_store.use_count() > 1) {
+        Release();
+        _store = _store->Clone();
+      }
+      _store->_file = this;
+    }
+    /// Stop modifying the sections of the store, before the store is left to the copies of this file
+    void Release() {
+      if (_store->_file == this) _store->_file = NULL;
+    }
+    /// Section of this file with the name of @param sect, which can belong to a copy of this file
+    const Section* OwnSection(const Section* sect) const {
+      return sect->_store == _store.get() ? sect : _store->Find(sect->FullName());
+    }
+
+    /// Parse text of provided buffer to specified section map
+    /// Lines are tokenized in place, values keep views into @param buffer, only multiline values are copied
+    /// Only the text between @param begin and @param end offsets is parsed, @param first_line is the number of its first line
     /// Comments separated from closest section or key-value pair by 1 or more empty strings
     /// would be ignored
     /// Default section will be created if needed
-    int ParseStream(std::istream& stream, const std::string& def_section, const std::string& rpath, SectionMap& pmap) {
-      Section*    cur_sect = NULL;
-      std::string pcomment;
-      std::string prev_line;
+    int ParseBuffer(const std::shared_ptr<const TextBuffer>& buffer, const std::string& def_section, const std::string& rpath,
+                    size_t begin = 0, size_t end = std::string_view::npos, int first_line = 1) {
+      Section*         cur_sect = NULL;
+      std::string      pcomment;
+      LineReader       reader(buffer->View(), begin, end, first_line);
+      std::string_view line;
+      bool             in_buffer;
       _result.Invalidate();
 
       // Find whether default section already exists in provided map
       // if not - it will be created later if needed
-      SectionMap::iterator it = pmap.find(def_section);
-      if (it != pmap.end()) cur_sect = it->second;
+      SectionMap::iterator it = _store->_sections.find(def_section);
+      if (it != _store->_sections.end()) cur_sect = it->second;
 
-      for (int lnc = 1; !stream.eof(); lnc++) {
-        std::string line;
-        std::getline(stream, line);
-        trim(line);
+      while (reader.Next(line, in_buffer)) {
+        int lnc = reader.LineNumber();
         if (line.empty()) {
           pcomment.clear();
           continue;
         }
-        // Handle multiline strings
-        if (char_is_one_of(line.at(line.size() - 1), INI_MULTILINE_CHARS)) {
-          prev_line = prev_line + line.substr(0, line.size() - 1);
-          continue;
-        } else if (!prev_line.empty()) {
-          line = prev_line + line;
-          prev_line.clear();
-        }
-        std::string section_key, value, comment;
-        LineType    lt = ParseLine(line, section_key, section_key, value, comment);
+        std::string_view section_key, value, comment;
+        LineType         lt = ParseLine(line, section_key, section_key, value, comment);
         if (lt == LEKSYSINI_EMPTY) {
           pcomment.clear();
           continue;
         } else if (lt == LEKSYSINI_ERROR) {
-          _result.Set(INI_ERR_PARSING_ERROR, lnc, line);
+          _result.Set(INI_ERR_PARSING_ERROR, lnc, std::string(line));
           return 0;
         }
         // Handle inclusion
         else if (lt == LEKSYSINI_COMMENT && comment.substr(0, strlen(INI_INCLUDE_SEQ)) == INI_INCLUDE_SEQ) {
-          std::string incname = comment.substr(strlen(INI_INCLUDE_SEQ));
-          trim(incname);
-          normalize_path(incname);
+          std::string fpath  = IncludePath(comment, rpath);
+          std::string prevfn = _result.file_name;
+          _result.file_name  = fpath;
+          if (std::find(_include_stack.begin(), _include_stack.end(), fpath) != _include_stack.end()) {
+            _result.Set(INI_ERR_INCLUDE_CYCLE, lnc, std::string(line));
+            return 0;
+          }
           // try to open file
-          std::string fpath;
-          if (path_is_relative(incname) && !rpath.empty())
-            fpath = rpath + SYSTEM_PATH_DELIM + incname;
-          else
-            fpath = incname;
-          std::ifstream file(fpath.c_str(), std::ios::in);
-          std::string   prevfn = _result.file_name;
-          _result.file_name    = fpath;
-          if (!file.is_open()) {
-            _result.Set(INI_ERR_INVALID_FILENAME, lnc, line);
+          std::shared_ptr<const TextBuffer> file = OpenInclude(fpath);
+          if (!file) {
+            _result.Set(INI_ERR_INVALID_FILENAME, lnc, std::string(line));
             return 0;
           }
           std::string scname;
@@ -1192,23 +2562,27 @@ namespace INI {
             scname = cur_sect->FullName();
           else
             scname = def_section;
-          if (!ParseStream(file, scname, file_path(fpath), pmap)) return 0;
+          _include_stack.push_back(fpath);
+          int ret = ParseBuffer(file, scname, file_path(fpath));
+          _include_stack.pop_back();
+          if (!ret) return 0;
           _result.file_name = prevfn;
           continue;
         }
         // Add comment (it can be set with any string type, other than EMPTY and ERROR)
-        pcomment += comment;
+        if (!(_flags & INI_LOAD_NO_COMMENTS)) pcomment.append(comment.data(), comment.size());
         // Add section (or modify comment of existing one if needed)
         if (lt == LEKSYSINI_SECTION) {
-          SectionMap::iterator it = pmap.find(section_key);
-          if (it == pmap.end()) {
-            cur_sect = new Section(this, section_key, pcomment);
-            pmap.insert(SectionPair(section_key, cur_sect));
+          std::string          name(section_key);
+          if (_flags & INI_LOAD_FOLD_CASE) string_to_lower(name);
+          SectionMap::iterator it = _store->_sections.find(name);
+          if (it == _store->_sections.end()) {
+            cur_sect = _store->Insert(new Section(name, pcomment));
           } else {
             cur_sect = it->second;
             if (!pcomment.empty()) {
               if (!it->second->_comment.empty())
-                it->second->_comment += stream.widen('\n') + pcomment;
+                it->second->_comment += '\n' + pcomment;
               else
                 it->second->_comment = pcomment;
             }
@@ -1217,52 +2591,177 @@ namespace INI {
         } else if (lt == LEKSYSINI_ENTRY) {
           // Try to create default section if it is not already in the array
           if (!cur_sect) {
-            cur_sect = new Section(this, def_section);
-            pmap.insert(SectionPair(def_section, cur_sect));
+            cur_sect = _store->Insert(new Section(def_section));
           }
-          cur_sect->SetValue(section_key, value, pcomment);
+          // values from the buffer itself are not copied
+          Value val = in_buffer ? Value(value, buffer) : Value(std::string(value));
+          if (_flags & INI_LOAD_TYPED) val.Classify();
+          std::string key(section_key);
+          if (_flags & INI_LOAD_FOLD_CASE) string_to_lower(key);
+          cur_sect->SetValue(key, val, pcomment);
           pcomment.clear();
         }
       }
-      // Clears eof flag for future usage of stream
-      stream.clear();
       return 1;
     }
     /// Save provided section map to stream
-    void SaveStream(std::ostream& stream, const SectionMap& pmap) const {
+    /// Text is formatted in memory and written to the stream in large blocks
+    static void SaveStream(std::ostream& stream, const SectionMap& pmap) {
+      std::string out;
       for (SectionMap::const_iterator it = pmap.begin(); it != pmap.end(); ++it) {
+        it->second->_store->Materialize(it->second);
         if (it->second->ValuesSize() == 0) continue;
-        if (!it->second->Comment().empty()) AddCommentToStream(stream, it->second->Comment());
-        if (!it->first.empty()) stream << INI_SECTION_OPEN_CHARS[0] << it->first << INI_SECTION_CLOSE_CHARS[0] << std::endl;
-        for (Section::values_iter vit = it->second->ValuesBegin(); vit != it->second->ValuesEnd(); vit++) {
-          stream << vit->first << " " << INI_NAME_VALUE_SEP_CHARS[0] << " " << vit->second.AsString();
-          std::string cmn = it->second->GetComment(vit->first);
-          if (!cmn.empty()) stream << " " << INI_COMMENT_CHARS[0] << cmn;
-          stream << std::endl;
+        if (!it->second->Comment().empty()) AppendComment(out, it->second->Comment());
+        AppendSectionName(out, it->first);
+        for (Section::values_iter vit = it->second->ValuesBegin(); vit != it->second->ValuesEnd(); vit++)
+          AppendEntry(out, vit->first, vit->second, it->second->GetComment(vit->first));
+        out += '\n';
+        if (out.size() >= WRITE_BLOCK_SIZE) {
+          stream.write(out.data(), out.size());
+          out.clear();
         }
-        stream << std::endl;
+      }
+      stream.write(out.data(), out.size());
+    }
+    /// Append comment lines with @param str to @param out
+    static void AppendComment(std::string& out, const std::string& str) {
+      std::vector<std::string> ar = split_string(str, "\n");
+      for (size_t i = 0; i < ar.size(); i++) {
+        out += INI_COMMENT_CHARS[0];
+        out += ar[i];
+        out += '\n';
       }
     }
+    /// Append line with section @param name to @param out (nothing is added for default section)
+    static void AppendSectionName(std::string& out, const std::string& name) {
+      if (name.empty()) return;
+      out += INI_SECTION_OPEN_CHARS[0];
+      out += name;
+      out += INI_SECTION_CLOSE_CHARS[0];
+      out += '\n';
+    }
+    /// Append line with @param key, its value @param val and @param comment to @param out
+    static void AppendEntry(std::string& out, const std::string& key, const Value& val, const std::string& comment) {
+      out += key;
+      out += ' ';
+      out += INI_NAME_VALUE_SEP_CHARS[0];
+      out += ' ';
+      out += val.View();
+      if (!comment.empty()) {
+        out += ' ';
+        out += INI_COMMENT_CHARS[0];
+        out += comment;
+      }
+      out += '\n';
+    }
 
   private:
-    void DeleteSections(SectionMap& mp) {
-      for (SectionMap::iterator it = mp.begin(); it != mp.end(); ++it) delete (it->second);
-      mp.clear();
+    // size of blocks of text written to stream
+    static constexpr size_t WRITE_BLOCK_SIZE = 0x10000;
+    /// Position of a value in the text of file to be patched
+    struct PatchPosition {
+      std::vector<TextChunk> lines;         // all lines with the value
+      TextChunk              value;         // text of the last value
+      std::string            old_value;     // last value
+      bool                   replace_line;  // the whole last line has to be replaced instead of the value text
+    };
+    /// Replacement of a part of the text of file to be patched
+    struct PatchEdit {
+      size_t      begin;
+      size_t      end;
+      std::string text;
+    };
+    /// Included file in the cache shared by all files of the process
+    /// State of a file, that changes when the file is modified or replaced
+    struct FileState {
+      long long mtime      = 0;
+      long long mtime_nsec = 0;
+      uintmax_t size       = 0;
+      uintmax_t inode      = 0;
+      bool      operator==(const FileState& rhs) const {
+        return mtime == rhs.mtime && mtime_nsec == rhs.mtime_nsec && size == rhs.size && inode == rhs.inode;
+      }
+    };
+    struct CachedInclude {
+      std::shared_ptr<const TextBuffer> buffer;
+      FileState                         state;
+      // value of IncludeCache::uses, when the file was used last time
+      unsigned long long                last_use = 0;
+    };
+    struct IncludeCache {
+      std::mutex                           mutex;
+      std::map<std::string, CachedInclude> files;
+      size_t                               limit = INI_INCLUDE_CACHE_SIZE;
+      // number of uses of cached files
+      unsigned long long                   uses  = 0;
+    };
+    static IncludeCache& SharedIncludes() {
+      static IncludeCache cache;
+      return cache;
+    }
+    /// Drop the least recently used files from @param cache, until it is within its limit (cache is locked by the caller)
+    static void EvictIncludes(IncludeCache& cache) {
+      while (cache.files.size() > cache.limit) {
+        std::map<std::string, CachedInclude>::iterator oldest = cache.files.begin();
+        for (std::map<std::string, CachedInclude>::iterator it = cache.files.begin(); it != cache.files.end(); ++it)
+          if (it->second.last_use < oldest->second.last_use) oldest = it;
+        cache.files.erase(oldest);
+      }
     }
-    // All sections (including subsections) in one map
-    SectionMap _sections;
-    PResult    _result;
+    typedef std::map<std::string, std::shared_ptr<const TextBuffer>> IncludeMap;
+    // All sections (including subsections), shared with copies of the file
+    std::shared_ptr<SectionStore> _store;
+    PResult                       _result;
+    // INI_LOAD_* flags of the current load operation
+    int                           _flags = INI_LOAD_DEFAULT;
+    // files included during the current load operation by their paths
+    IncludeMap                    _includes;
+    // paths of the files being parsed, the innermost one is the last
+    std::vector<std::string>      _include_stack;
   };
 
   /*-----------------------------------------------------------------------------------------------------------/
   / Some functions left unimplemented
   /-----------------------------------------------------------------------------------------------------------*/
-  inline Section*      Section::GetParent() { return _file->GetParentSection(this); }
-  inline Section*      Section::FindParent() const { return _file->FindParentSection(this); }
-  inline Section*      Section::GetSubSection(const std::string& name) { return _file->GetSubSection(this, name); }
-  inline Section*      Section::FindSubSection(const std::string& name) const { return _file->FindSubSection(this, name); }
-  inline SectionVector Section::FindSubSections() const { return _file->FindSubSections(this); }
-  inline void          Section::Save(std::ostream& stream) const { return _file->Save(stream, this); }
+  inline const Section*     Section::FindParent() const { return _store->FindParent(this); }
+  inline Section*           Section::FindParent() {
+    return _store->_file ? _store->_file->FindParentSection(this) : _store->FindParent(this);
+  }
+  inline Section*           Section::GetParent() {
+    return _store->_file ? _store->_file->GetParentSection(this) : _store->GetParent(this);
+  }
+  inline const Section*     Section::FindSubSection(const std::string& name) const { return _store->FindSubSection(this, name); }
+  inline Section*           Section::FindSubSection(const std::string& name) {
+    return _store->_file ? _store->_file->FindSubSection(this, name) : _store->FindSubSection(this, name);
+  }
+  inline Section*           Section::GetSubSection(const std::string& name) {
+    return _store->_file ? _store->_file->GetSubSection(this, name) : _store->GetSubSection(this, name);
+  }
+  inline ConstSectionVector Section::FindSubSections() const {
+    SectionVector subs = _store->FindSubSections(this);
+    return ConstSectionVector(subs.begin(), subs.end());
+  }
+  inline SectionVector      Section::FindSubSections() {
+    return _store->_file ? _store->_file->FindSubSections(this) : _store->FindSubSections(this);
+  }
+  inline void               Section::Save(std::ostream& stream) const { return File::Save(stream, this); }
+
+  inline void          SectionStore::Materialize(Section* sect) const {
+    if (!sect->_lazy.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (sect->_pending.empty()) return;
+    // chunks are parsed to a separate file and merged to the section the same way as by parallel loading
+    File part;
+    part._flags = _lazy_flags;
+    for (size_t i = 0; i < sect->_pending.size(); ++i) {
+      const TextChunk& chunk = sect->_pending[i];
+      part.ParseBuffer(_lazy_text, sect->FullName(), "", chunk.begin, chunk.end, chunk.line);
+    }
+    Section* parsed = part._store->Find(sect->FullName());
+    if (parsed) sect->Merge(*parsed);
+    sect->_pending.clear();
+    sect->_lazy.store(false, std::memory_order_release);
+  }
 }  // namespace INI
 /*---------------------------------------------------------------------------------------------------------------/
 / Stream operators
@@ -1300,6 +2799,10 @@ static inline std::istream& operator>>(std::istream& stream, INI::File& file) {
 #undef INI_SECTION_VALUE_DELIMETER
 #undef INI_INCLUDE_SEQ
 #undef SYSTEM_PATH_DELIM
+#undef INI_HAS_MMAP
+#undef INI_PARALLEL_CHUNK_SIZE
+#undef INI_INCLUDE_CACHE_SIZE
+#undef INI_STAT_MTIME_NSEC
 // Note: error definitions are left
 
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#include <green/params/snapshot_server.h>
+
+#include <atomic>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+  std::atomic<bool> stop(false);
+
+  void              handle_signal(int) { stop = true; }
+}  // namespace
+
+/**
+ * Serve values of parameters INI files to processes on the node over a Unix domain socket, see `params::set_snapshot_server`
+ *
+ * Usage: green-params-served SOCKET [INI files to load in advance...]
+ */
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " SOCKET [INI files to load in advance...]" << std::endl;
+    return 1;
+  }
+  try {
+    green::params::snapshot_server server(argv[1]);
+    for (int i = 2; i < argc; ++i) server.snapshot_of(std::filesystem::absolute(argv[i]).string(), false);
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+    server.serve(stop);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
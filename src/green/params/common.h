@@ -5,11 +5,104 @@
 #ifndef GREEN_PARAMS_COMMON_H
 #define GREEN_PARAMS_COMMON_H
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <complex>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 #include "except.h"
 
 namespace green::params {
+  namespace internal {
+    template <typename T>
+    struct is_vector_t : std::false_type {};
+    template <typename T>
+    struct is_vector_t<std::vector<T>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_vector_v = is_vector_t<T>::value;
+    template <typename T>
+    struct is_array_t : std::false_type {};
+    template <typename T, size_t N>
+    struct is_array_t<std::array<T, N>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_array_v = is_array_t<T>::value;
+    template <typename T>
+    struct is_complex_t : std::false_type {};
+    template <typename T>
+    struct is_complex_t<std::complex<T>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_complex_v = is_complex_t<T>::value;
+
+    /**
+     * Hash of names of parameters, that ignores case of the names if `fold` is set
+     */
+    struct name_hash {
+      bool   fold = false;
+      size_t operator()(const std::string& name) const {
+        if (!fold) return std::hash<std::string>()(name);
+        std::uint64_t hash = 14695981039346656037ull;  // FNV-1a of the lower case name
+        for (unsigned char c : name) hash = (hash ^ std::uint64_t(std::tolower(c))) * 1099511628211ull;
+        return size_t(hash);
+      }
+    };
+
+    /**
+     * Equality of names of parameters, that ignores case of the names if `fold` is set
+     */
+    struct name_equal {
+      bool fold = false;
+      bool operator()(const std::string& lhs, const std::string& rhs) const {
+        if (!fold) return lhs == rhs;
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](unsigned char l, unsigned char r) { return std::tolower(l) == std::tolower(r); });
+      }
+    };
+
+    /**
+     * Remove leading and trailing whitespaces from a string view
+     */
+    inline std::string_view trim(std::string_view s) {
+      while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+      while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+      return s;
+    }
+
+    /**
+     * Convert the whole string view into a number without allocations
+     *
+     * @tparam V - arithmetic type
+     * @param field - text to convert
+     * @param context - text reported in the error message
+     * @return converted number
+     */
+    template <typename V>
+    V parse_number(std::string_view field, std::string_view context) {
+      V value{};
+      if (!field.empty() && field.front() == '+') field.remove_prefix(1);
+      std::from_chars_result res = std::from_chars(field.data(), field.data() + field.size(), value);
+      if (field.empty() || res.ec != std::errc() || res.ptr != field.data() + field.size())
+        throw params_convert_error("Can not convert '" + std::string(field) + "' in '" + std::string(context) + "'");
+      return value;
+    }
+
+    /**
+     * Shortest string representation of a number that is converted back into the same number
+     */
+    template <typename V>
+    std::string number_to_string(V value) {
+      char                 buf[64];
+      std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), value);
+      return std::string(buf, res.ptr);
+    }
+  }  // namespace internal
+
   /**
    * Convert string string with command line parameters int [argc, argv] pair
    *
@@ -53,6 +53,36 @@ namespace green::params {
   public:
     explicit params_empty_name_error(const std::string& string) : runtime_error(string) {}
   };
+
+  class params_transport_error : public std::runtime_error {
+  public:
+    explicit params_transport_error(const std::string& string) : runtime_error(string) {}
+  };
+
+  class params_serialize_error : public std::runtime_error {
+  public:
+    explicit params_serialize_error(const std::string& string) : runtime_error(string) {}
+  };
+
+  class params_shared_memory_error : public std::runtime_error {
+  public:
+    explicit params_shared_memory_error(const std::string& string) : runtime_error(string) {}
+  };
+
+  class params_lock_error : public std::runtime_error {
+  public:
+    explicit params_lock_error(const std::string& string) : runtime_error(string) {}
+  };
+
+  class params_server_error : public std::runtime_error {
+  public:
+    explicit params_server_error(const std::string& string) : runtime_error(string) {}
+  };
+
+  class params_consistency_error : public std::runtime_error {
+  public:
+    explicit params_consistency_error(const std::string& string) : runtime_error(string) {}
+  };
 }  // namespace green::params
 
 #endif  // GREEN_PARAMS_EXCEPT_H
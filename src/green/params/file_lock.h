@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_FILE_LOCK_H
+#define GREEN_PARAMS_FILE_LOCK_H
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "except.h"
+
+namespace green::params::internal {
+  /**
+   * Exclusive advisory lock of a file (flock), held while the object is alive. Lock file is created if it does not exist.
+   * Processes and threads that open the same lock file wait for each other.
+   */
+  class file_lock {
+  public:
+    explicit file_lock(const std::string& path) {
+      fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+      if (fd_ < 0) throw params_lock_error("Can not open lock file " + path + ": " + strerror(errno));
+      int res;
+      while ((res = flock(fd_, LOCK_EX)) != 0 && errno == EINTR) {
+      }
+      if (res != 0) {
+        close(fd_);
+        throw params_lock_error("Can not lock file " + path + ": " + strerror(errno));
+      }
+    }
+    file_lock(const file_lock&)            = delete;
+    file_lock& operator=(const file_lock&) = delete;
+    ~file_lock() {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+
+  private:
+    int fd_;
+  };
+
+  /**
+   * Modification time (in ticks of the file clock) and size of a file, that change when the file is modified
+   */
+  using file_state = std::pair<std::int64_t, std::uint64_t>;
+
+  inline file_state state_of(const std::string& path) {
+    std::error_code ec;
+    auto            time = std::filesystem::last_write_time(path, ec);
+    auto            size = std::filesystem::file_size(path, ec);
+    return file_state(time.time_since_epoch().count(), size);
+  }
+
+  /**
+   * Read whole file into `data`
+   *
+   * @return false if file does not exist or can not be read
+   */
+  inline bool read_file(const std::string& path, std::string& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+  }
+
+  /**
+   * Write `data` into file atomically: other processes see either no file or its full content
+   */
+  inline void write_file(const std::string& path, std::string_view data) {
+    std::string tmp = path + "." + std::to_string(getpid()) + ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      out.write(data.data(), data.size());
+      if (!out) throw params_lock_error("Can not write file " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      throw params_lock_error("Can not write file " + path + ": " + strerror(errno));
+    }
+  }
+}  // namespace green::params::internal
+
+#endif  // GREEN_PARAMS_FILE_LOCK_H
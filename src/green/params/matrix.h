@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_MATRIX_H
+#define GREEN_PARAMS_MATRIX_H
+
+#include <ini/iniparser.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+#include "except.h"
+
+namespace green::params {
+  /**
+   * Dense matrix parameter stored in a single contiguous aligned row-major buffer. Parsed from a comma-separated list of
+   * rows, each row is enclosed in INI array segment braces, e.g. `{1,0,0},{0,1,0}`. A list without braces is a single row.
+   *
+   * @tparam T - arithmetic type of elements
+   */
+  template <typename T>
+  class matrix {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "matrix is only defined for arithmetic types");
+
+  public:
+    using value_type                  = T;
+    /// alignment of the data buffer in bytes
+    static constexpr size_t alignment = 64;
+
+    matrix() = default;
+    matrix(size_t rows, size_t cols) : rows_(rows), cols_(cols), data_(allocate(rows * cols)) { std::fill(begin(), end(), T(0)); }
+    matrix(const matrix& rhs) : rows_(rhs.rows_), cols_(rhs.cols_), data_(allocate(rhs.size())) {
+      std::copy(rhs.begin(), rhs.end(), begin());
+    }
+    matrix(matrix&& rhs) noexcept : rows_(rhs.rows_), cols_(rhs.cols_), data_(rhs.data_) {
+      rhs.rows_ = rhs.cols_ = 0;
+      rhs.data_             = nullptr;
+    }
+    ~matrix() { deallocate(data_); }
+    matrix& operator=(const matrix& rhs) {
+      if (this == &rhs) return *this;
+      if (size() != rhs.size()) {
+        deallocate(data_);
+        data_ = allocate(rhs.size());
+      }
+      rows_ = rhs.rows_;
+      cols_ = rhs.cols_;
+      std::copy(rhs.begin(), rhs.end(), begin());
+      return *this;
+    }
+    matrix& operator=(matrix&& rhs) noexcept {
+      std::swap(rows_, rhs.rows_);
+      std::swap(cols_, rhs.cols_);
+      std::swap(data_, rhs.data_);
+      return *this;
+    }
+
+    /**
+     * Parse matrix from string `{a11,a12,...},{a21,a22,...},...`
+     *
+     * @param str - string representation of the matrix
+     */
+    explicit matrix(const std::string& str) {
+      std::string_view text = internal::trim(str);
+      std::vector<T>   values;
+      size_t           ncols = 0;
+      size_t           nrows = 0;
+      if (text.empty()) return;
+      if (text.front() != segment_open) {
+        parse_row(text, values, str);
+        nrows = 1;
+        ncols = values.size();
+      } else {
+        size_t pos = 0;
+        while (pos < text.size()) {
+          if (text[pos] != segment_open)
+            throw params_convert_error(std::string("Matrix row should start with '") + segment_open + "' in '" + str + "'");
+          size_t close = text.find(segment_close, pos);
+          if (close == std::string_view::npos)
+            throw params_convert_error(std::string("Unmatched '") + segment_open + "' in matrix '" + str + "'");
+          size_t before = values.size();
+          parse_row(text.substr(pos + 1, close - pos - 1), values, str);
+          if (nrows == 0) ncols = values.size() - before;
+          if (values.size() - before != ncols)
+            throw params_convert_error("Matrix rows have different lengths in '" + str + "'");
+          ++nrows;
+          pos = close + 1;
+          while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+          if (pos == text.size()) break;
+          if (text[pos] != ',') throw params_convert_error("Matrix rows should be separated by ',' in '" + str + "'");
+          ++pos;
+          while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+          if (pos == text.size()) throw params_convert_error("Trailing ',' in matrix '" + str + "'");
+        }
+      }
+      rows_ = nrows;
+      cols_ = ncols;
+      data_ = allocate(values.size());
+      std::copy(values.begin(), values.end(), data_);
+    }
+
+    [[nodiscard]] size_t   rows() const { return rows_; }
+    [[nodiscard]] size_t   cols() const { return cols_; }
+    /// distance in elements between starts of two consecutive rows
+    [[nodiscard]] size_t   stride() const { return cols_; }
+    [[nodiscard]] size_t   size() const { return rows_ * cols_; }
+    [[nodiscard]] bool     empty() const { return size() == 0; }
+    [[nodiscard]] T*       data() { return data_; }
+    [[nodiscard]] const T* data() const { return data_; }
+    [[nodiscard]] T*       row(size_t i) { return data_ + i * stride(); }
+    [[nodiscard]] const T* row(size_t i) const { return data_ + i * stride(); }
+    T&                     operator()(size_t i, size_t j) { return data_[i * stride() + j]; }
+    const T&               operator()(size_t i, size_t j) const { return data_[i * stride() + j]; }
+    T*                     begin() { return data_; }
+    T*                     end() { return data_ + size(); }
+    const T*               begin() const { return data_; }
+    const T*               end() const { return data_ + size(); }
+
+    bool                   operator==(const matrix& rhs) const {
+      return rows_ == rhs.rows_ && cols_ == rhs.cols_ && std::equal(begin(), end(), rhs.begin());
+    }
+    bool operator!=(const matrix& rhs) const { return !(*this == rhs); }
+
+    /**
+     * Print matrix in the form that is parsed back into the same matrix
+     */
+    friend std::ostream& operator<<(std::ostream& out, const matrix& m) {
+      for (size_t i = 0; i < m.rows_; ++i) {
+        out << (i == 0 ? "" : ",") << segment_open;
+        for (size_t j = 0; j < m.cols_; ++j) out << (j == 0 ? "" : ",") << internal::number_to_string(m(i, j));
+        out << segment_close;
+      }
+      return out;
+    }
+
+  private:
+    // same characters as INI array segments, so that matrix can be written as array of arrays in INI file
+    static constexpr char segment_open  = INI::ARRAY_SEGMENT_OPEN;
+    static constexpr char segment_close = INI::ARRAY_SEGMENT_CLOSE;
+
+    size_t                rows_ = 0;
+    size_t                cols_ = 0;
+    T*                    data_ = nullptr;
+
+    static T*             allocate(size_t n) {
+      if (n == 0) return nullptr;
+      return static_cast<T*>(::operator new[](n * sizeof(T), std::align_val_t(alignment)));
+    }
+    static void deallocate(T* p) {
+      if (p) ::operator delete[](p, std::align_val_t(alignment));
+    }
+
+    static void parse_row(std::string_view row, std::vector<T>& values, const std::string& str) {
+      size_t begin = 0;
+      for (size_t pos = 0; pos <= row.size(); ++pos) {
+        if (pos != row.size() && row[pos] != ',') continue;
+        values.push_back(internal::parse_number<T>(internal::trim(row.substr(begin, pos - begin)), str));
+        begin = pos + 1;
+      }
+    }
+  };
+
+  namespace internal {
+    template <typename T>
+    struct is_matrix_t : std::false_type {};
+    template <typename T>
+    struct is_matrix_t<matrix<T>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_matrix_v = is_matrix_t<T>::value;
+  }  // namespace internal
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_MATRIX_H
@@ -9,26 +9,38 @@
 #include <argparse/argparse.h>
 #include <ini/iniparser.h>
 
+#include <algorithm>
+#include <array>
+#include <complex>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <typeindex>
 #include <unordered_set>
 
 #include "common.h"
 #include "except.h"
+#include "file_lock.h"
+#include "matrix.h"
+#include "range.h"
+#include "rle_vector.h"
+#include "serialize.h"
+#include "shared_memory.h"
+#include "snapshot_server.h"
+#include "transport.h"
 
 namespace green::params {
 
   namespace internal {
     template <typename T>
-    struct is_vector_t : std::false_type {};
+    constexpr bool is_valid_type = is_vector_v<T> || is_array_v<T> || is_complex_v<T> || is_range_v<T> || is_rle_vector_v<T> ||
+                                   is_matrix_v<T> || std::is_same_v<std::remove_const_t<T>, std::string> ||
+                                   std::is_arithmetic_v<T> || std::is_enum_v<T>;
+    /// types that collect several consecutive command line values into one comma-separated value
     template <typename T>
-    struct is_vector_t<std::vector<T>> : std::true_type {};
-    template <typename T>
-    constexpr bool is_vector_v = is_vector_t<T>::value;
-    template <typename T>
-    constexpr bool is_valid_type =
-        is_vector_v<T> || std::is_same_v<std::remove_const_t<T>, std::string> || std::is_arithmetic_v<T> || std::is_enum_v<T>;
+    constexpr bool is_multi_argument_v = is_vector_v<T> || is_array_v<T> || is_rle_vector_v<T> || is_matrix_v<T>;
   }  // namespace internal
 
   /**
@@ -42,10 +54,12 @@ namespace green::params {
      * @param name  - name of the parameter
      * @param entry - argparse parameter entry
      * @param argument_type - type of the parameter
+     * @param codec - binary serialization of values of the parameter type
      * @param default_value - defalt value (optional)
      */
-    params_item(const std::string& name, argparse::Entry* entry, std::type_index argument_type) :
-        entry_(entry), argument_type_(argument_type), optional_(false) {
+    params_item(const std::string& name, argparse::Entry* entry, std::type_index argument_type,
+                const internal::value_codec* codec = nullptr) :
+        entry_(entry), argument_type_(argument_type), codec_(codec), optional_(false) {
       std::vector<std::string> names = argparse::split(name);
       name_                          = names[0];
       aka_.insert(aka_.begin(), names.begin() + 1, names.end());
@@ -153,12 +167,13 @@ namespace green::params {
     [[nodiscard]] argparse::Entry*                entry() const { return entry_; }
 
   private:
-    std::string                name_;
-    std::vector<std::string>   aka_;
-    argparse::Entry*           entry_;
-    std::type_index            argument_type_;
-    std::optional<std::string> default_value_;
-    bool                       optional_;
+    std::string                  name_;
+    std::vector<std::string>     aka_;
+    argparse::Entry*             entry_;
+    std::type_index              argument_type_;
+    const internal::value_codec* codec_;
+    std::optional<std::string>   default_value_;
+    bool                         optional_;
 
     friend class params;
   };
@@ -172,9 +187,14 @@ namespace green::params {
      * Create parameters dictionary
      *
      * @param description - name of the parameters (used for printing)
+     * @param case_insensitive - match names of parameters in command line, INI file and on access ignoring their case
      */
-    params(const std::string& description = "") : parsed_(false), built_(false), description_(description), inifile_(nullptr) {
+    params(const std::string& description = "", bool case_insensitive = false) :
+        parsed_(false), built_(false), case_insensitive_(case_insensitive),
+        parameters_map_(0, internal::name_hash{case_insensitive}, internal::name_equal{case_insensitive}),
+        description_(description), inifile_(nullptr) {
       inifile_ = &args_.arg_t<std::string>("Parameters INI File").set_default("");
+      if (case_insensitive_) args_.set_case_insensitive();
     }
 
     /**
@@ -191,16 +211,17 @@ namespace green::params {
         throw params_empty_name_error("Can not define parameter with an empty name");
       }
       built_                              = false;
-      auto [names, redefinied, old_entry] = check_redefiniton<T>(argparse::split(name));
+      std::vector<std::string> all_names  = keys(name);
+      auto [names, redefinied, old_entry] = check_redefiniton<T>(all_names);
       argparse::Entry* entry              = redefinied ? old_entry : &args_.kwarg_t<T>(name, descr);
       entry->clean_error();
-      if constexpr (internal::is_vector_v<T>) entry->multi_argument();
+      if constexpr (internal::is_multi_argument_v<T>) entry->multi_argument();
       if (default_value.has_value()) entry->set_default(default_value.value());
       std::shared_ptr<params_item> ptr;
       if (!redefinied) {
-        ptr = std::make_shared<params_item>(name, entry, typeid(T));
+        ptr = std::make_shared<params_item>(name, entry, typeid(T), internal::codec_of<T>());
       } else {
-        for (auto curr_name : argparse::split(name)) {
+        for (const auto& curr_name : all_names) {
           if (parameters_map_.count(curr_name) > 0) {
             ptr            = parameters_map_[curr_name];
             ptr->optional_ = ptr->optional_ || default_value.has_value();
@@ -216,6 +237,7 @@ namespace green::params {
         }
       }
       params_set_.insert(ptr);
+      schema_.clear();
     }
 
     /**
@@ -234,10 +256,11 @@ namespace green::params {
       if (!parsed_) throw params_notparsed_error("Parameters has to be parsed before access.");
 #endif
       if (!built_) build();
-      if (parameters_map_.count(param_name) <= 0) {
+      auto it = parameters_map_.find(param_name);
+      if (it == parameters_map_.end()) {
         throw params_notfound_error("Parameter " + param_name + " is not found.");
       }
-      params_item& item = *parameters_map_.at(param_name).get();
+      params_item& item = *it->second.get();
       if (!item.is_optional() && !item.is_set() || item.entry()->has_error()) {
         if (item.entry()->has_error()) {
           throw params_value_error("Accessing incorrectly filled parameter '" + param_name + "'\n" + item.entry()->get_error());
@@ -257,10 +280,11 @@ namespace green::params {
       if (!parsed_) throw params_notparsed_error("Parameters has to be parsed before access.");
       if (!built_) throw params_notbuilt_error("Parameters has to be built before access if passing const params.");
 #endif
-      if (parameters_map_.count(param_name) <= 0) {
+      auto it = parameters_map_.find(param_name);
+      if (it == parameters_map_.end()) {
         throw params_notfound_error("Parameter " + param_name + " is not found.");
       }
-      const params_item& item = *parameters_map_.at(param_name).get();
+      const params_item& item = *it->second.get();
       if (!item.is_optional() && !item.is_set() || item.entry()->has_error()) {
         if (item.entry()->has_error()) {
           throw params_value_error("Accessing incorrectly filled parameter '" + param_name + "'\n" + item.entry()->get_error());
@@ -278,10 +302,11 @@ namespace green::params {
      * not exist.
      */
     [[nodiscard]] bool is_set(const std::string& param_name) const {
-      if (parameters_map_.count(param_name) <= 0) {
+      auto it = parameters_map_.find(param_name);
+      if (it == parameters_map_.end()) {
         return false;
       }
-      return parameters_map_.at(param_name).get()->is_set();
+      return it->second->is_set();
     }
 
     /**
@@ -303,12 +328,235 @@ namespace green::params {
      * @return false if help requested, true otherwise
      */
     bool parse(int argc, char* argv[]) {
-      args_.parse(argc, argv, false);
+      ini_text_.reset();
+      return parse_arguments(argc, argv);
+    }
+
+    /**
+     * Parse command line arguments represented as a string and read parameters, that are not set in the command line, from
+     * INI text in memory instead of INI file. The text is copied and used until parameters are parsed again.
+     *
+     * @param s - string with command line arguments
+     * @param ini_text - content of parameters INI file
+     * @return false if help requested, true otherwise
+     */
+    bool parse(const std::string& s, std::string_view ini_text) {
+      std::string to_parse = s;
+      auto [argc, argv]    = get_argc_argv(to_parse);
+      return parse(argc, argv, ini_text);
+    }
+
+    /**
+     * Parse standard command line arguments and read parameters, that are not set in the command line, from INI text in
+     * memory instead of INI file. The text is copied and used until parameters are parsed again.
+     *
+     * @param argc - number of command line arguments
+     * @param argv - values of command line arguments
+     * @param ini_text - content of parameters INI file
+     * @return false if help requested, true otherwise
+     */
+    bool parse(int argc, char* argv[], std::string_view ini_text) {
+      ini_text_ = std::string(ini_text);
+      return parse_arguments(argc, argv);
+    }
+
+    /**
+     * Read parameters INI file only on the leader process of `tr`, other processes receive values of parameters from it.
+     * Building parameters becomes a collective operation, that has to be called by all processes in the same order.
+     *
+     * @param tr - transport between processes, NULL to read INI file on every process
+     */
+    void set_transport(std::shared_ptr<transport> tr) {
+      transport_ = std::move(tr);
+      built_     = false;
+    }
+
+    /**
+     * Coordinate processes on one node through an advisory lock file, so that only one of them reads parameters INI file.
+     * The first process that takes the lock builds parameters and writes resolved snapshot into `directory`, other processes
+     * wait for the lock and load the snapshot. Snapshot is reused while command line, definitions, INI file and files it
+     * includes are unchanged. There is one snapshot and one lock file for every combination of definitions, command line
+     * and path of INI file, snapshot of modified INI file replaces the previous one. Files are not removed, so `directory`
+     * is expected to be cleaned with the job (e.g. job-local /tmp). Ignored if transport between processes is set.
+     *
+     * @param directory - node-local directory for lock file and snapshots (e.g. /tmp or /dev/shm), empty to disable
+     */
+    void set_node_snapshot(const std::string& directory) {
+      node_snapshot_ = directory;
+      built_         = false;
+    }
+
+    /**
+     * Fetch values of parameters INI file from `green-params-served` listening on Unix domain socket instead of parsing the
+     * file. INI file is parsed locally if the server is not available.
+     *
+     * @param socket - path of the socket of the server, empty to always parse INI file locally
+     */
+    void set_snapshot_server(const std::string& socket) {
+      snapshot_server_ = socket;
+      built_           = false;
+    }
+
+    /**
+     * Serialize resolved parameters into a compact binary buffer. Buffer starts with the format version, a hash of names
+     * and types of all parameters and the hash of their values, followed by name, type tag, flags, string value, error and
+     * typed value of every parameter. String values, that are the text of typed values, are restored from typed values.
+     *
+     * @return buffer that can be restored with `deserialize` by parameters with the same definitions
+     */
+    [[nodiscard]] std::string serialize() const {
+      if (!built_) throw params_notbuilt_error("Parameters has to be built before serialization.");
+      const std::vector<params_item*>& items = schema();
+      std::string                      buffer(internal::serialize_magic);
+      internal::write_raw(buffer, serialize_version);
+      internal::write_raw(buffer, schema_hash_);
+      internal::write_raw(buffer, hash_);
+      internal::write_raw<std::uint64_t>(buffer, items.size());
+      std::string text;
+      for (const params_item* item : items) {
+        const argparse::Entry&     entry = *item->entry();
+        std::optional<std::string> value = entry.string_value();
+        // text, that is restored from the typed value, is not stored
+        bool typed = value.has_value() && !entry.has_error() && item->codec_->format(entry, text) && text == value.value();
+        internal::write_string(buffer, item->name());
+        internal::write_string(buffer, item->codec_->tag);
+        internal::write_raw<std::uint8_t>(buffer, (value.has_value() ? serialized_has_value : 0) |
+                                                      (entry.is_set() ? serialized_is_set : 0) |
+                                                      (typed ? serialized_typed_text : 0));
+        if (value.has_value() && !typed) internal::write_string(buffer, value.value());
+        internal::write_string(buffer, entry.get_error());
+        item->codec_->write(buffer, entry);
+      }
+      return buffer;
+    }
+
+    /**
+     * Restore parameters from a buffer created by `serialize`. Typed values are restored without any conversion from
+     * strings, so parameters do not have to be parsed. Parameters have to be defined the same way as the serialized ones.
+     *
+     * @param buffer - serialized parameters
+     */
+    void deserialize(std::string_view buffer) {
+      const std::vector<params_item*>& items = schema();
+      if (buffer.substr(0, internal::serialize_magic.size()) != internal::serialize_magic)
+        throw params_serialize_error("Buffer does not contain serialized parameters");
+      buffer.remove_prefix(internal::serialize_magic.size());
+      if (internal::read_raw<std::uint32_t>(buffer) != serialize_version)
+        throw params_serialize_error("Parameters were serialized with a different version of the format");
+      if (internal::read_raw<std::uint64_t>(buffer) != schema_hash_)
+        throw params_serialize_error("Serialized parameters have different definitions");
+      std::uint64_t hash = internal::read_raw<std::uint64_t>(buffer);
+      if (internal::read_raw<std::uint64_t>(buffer) != items.size())
+        throw params_serialize_error("Serialized parameters have different definitions");
+      for (params_item* item : items) {
+        if (internal::read_string(buffer) != item->name())
+          throw params_serialize_error("Serialized parameters have different definitions");
+        internal::read_string(buffer);
+        std::uint8_t               flags = internal::read_raw<std::uint8_t>(buffer);
+        std::optional<std::string> value;
+        if ((flags & serialized_has_value) && !(flags & serialized_typed_text)) value = internal::read_string(buffer);
+        std::string error(internal::read_string(buffer));
+        item->codec_->read(buffer, *item->entry());
+        if (flags & serialized_typed_text) {
+          value.emplace();
+          item->codec_->format(*item->entry(), *value);
+        }
+        item->entry()->restore(std::move(value), std::move(error), flags & serialized_is_set);
+      }
       parsed_ = true;
-      if (parameters_map_.empty() && argc > 2)
-        return false;  // we provided command line parameters but haven't defined any them yet
-      bool help_requested = build();
-      return !help_requested;
+      built_  = true;
+      hash_   = hash;
+    }
+
+    /**
+     * Hash of resolved parameters, computed when parameters are built. Parameters with the same names, types and values
+     * have the same hash regardless of the order of definitions and of where values come from.
+     *
+     * @return 64-bit FNV-1a hash of names, types and typed values of all parameters
+     */
+    [[nodiscard]] std::uint64_t hash() const {
+      if (!built_) throw params_notbuilt_error("Parameters has to be built before hashing.");
+      return hash_;
+    }
+
+    /**
+     * Check that parameters of all processes of `tr` are resolved to the same values. Collective operation, that has to be
+     * called by all processes after parameters are built.
+     *
+     * @param tr - transport between processes
+     * @throw params_consistency_error on all processes with the name of the first (by name) parameter that differs from
+     * the leader
+     * @throw params_transport_error on all processes if parameters differ and `tr` does not have exactly one leader
+     */
+    void check_consistency(transport& tr) const {
+      std::uint64_t              own    = hash();
+      std::vector<std::uint64_t> hashes = tr.all_gather(own);
+      if (std::all_of(hashes.begin(), hashes.end(), [&hashes](std::uint64_t h) { return h == hashes[0]; })) return;
+      std::vector<std::uint64_t> leaders = tr.all_gather(tr.is_leader());
+      // all processes see the same leaders, so that they throw together instead of waiting for a broadcast
+      if (std::count(leaders.begin(), leaders.end(), 1) != 1)
+        throw params_transport_error("Transport has to have exactly one leader, found " +
+                                     std::to_string(std::count(leaders.begin(), leaders.end(), 1)));
+      std::uint64_t reference = hashes[std::find(leaders.begin(), leaders.end(), 1) - leaders.begin()];
+      // the leader sends names and hashes of its parameters, every process finds the first parameter that differs
+      const std::vector<params_item*>& items  = schema();
+      std::vector<std::uint64_t>       values = value_hashes();
+      auto                             bytes  = [](const std::uint64_t& h) {
+        return std::string_view(reinterpret_cast<const char*>(&h), sizeof(h));
+      };
+      std::string buffer;
+      if (tr.is_leader()) {
+        for (size_t i = 0; i < items.size(); ++i) {
+          internal::append_field(buffer, items[i]->name());
+          internal::append_field(buffer, bytes(values[i]));
+        }
+      }
+      tr.broadcast(buffer);
+      std::string_view         leader(buffer);
+      std::vector<std::string> names;
+      std::string_view         name;
+      std::string_view         value;
+      bool                     differs = own != reference;
+      size_t                   first   = std::numeric_limits<size_t>::max();
+      while (internal::read_field(leader, name) && internal::read_field(leader, value)) {
+        size_t i = names.size();
+        names.emplace_back(name);
+        if (differs && first > i && (i >= items.size() || items[i]->name() != name || value != bytes(values[i]))) first = i;
+      }
+      // process with more parameters than the leader differs right after the last parameter of the leader
+      if (differs && first > names.size()) first = names.size();
+      std::vector<std::uint64_t> firsts   = tr.all_gather(first);
+      size_t                     min_rank = std::min_element(firsts.begin(), firsts.end()) - firsts.begin();
+      std::string                message  = "Parameters differ between processes, processes that differ from the leader:";
+      for (size_t rank = 0; rank < hashes.size(); ++rank)
+        if (hashes[rank] != reference) message += " " + std::to_string(rank);
+      if (firsts[min_rank] < names.size())
+        message += ". First differing parameter: '" + names[firsts[min_rank]] + "'";
+      else
+        message += ". Process " + std::to_string(min_rank) + " defines parameters that are not defined by the leader";
+      throw params_consistency_error(message);
+    }
+
+    /**
+     * Publish resolved parameters into a named shared-memory segment, so that other processes on the node can attach them
+     * without parsing command line and INI file. The segment exists while the returned object is alive.
+     *
+     * @param name - name of the shared-memory segment
+     * @return owner of the segment
+     */
+    [[nodiscard]] shared_segment publish(const std::string& name) const { return shared_segment::create(name, serialize()); }
+
+    /**
+     * Restore parameters from a shared-memory segment created by `publish` of parameters with the same definitions.
+     * Segment is mapped read-only and unmapped after parameters are restored. Values are copied into the parameters of this
+     * process, so that attaching saves the cost of parsing, but every process still keeps its own copy of all the values.
+     *
+     * @param name - name of the shared-memory segment
+     * @param timeout - time to wait for the segment to be published
+     */
+    void attach(const std::string& name, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+      shared_segment segment = shared_segment::attach(name, timeout);
+      deserialize(segment.data());
     }
 
     /**
@@ -344,38 +592,298 @@ namespace green::params {
     [[nodiscard]] const std::unordered_set<std::shared_ptr<params_item>>& params_set() const { return params_set_; }
 
   private:
+    // names are compared ignoring their case for case-insensitive parameters
+    using parameters_map_type =
+        std::unordered_map<std::string, std::shared_ptr<params_item>, internal::name_hash, internal::name_equal>;
+
     bool                                                          parsed_;
     bool                                                          built_;
+    // names are stored in lower case and INI file is loaded with lower case names
+    bool                                                          case_insensitive_;
     argparse::Args                                                args_;
-    std::unordered_map<std::string, std::shared_ptr<params_item>> parameters_map_;
+    parameters_map_type                                           parameters_map_;
     std::unordered_set<std::shared_ptr<params_item>>              params_set_;
     std::string                                                   description_;
     argparse::Entry*                                              inifile_;
+    // INI text supplied by the caller, used instead of INI file
+    std::optional<std::string>                                    ini_text_;
+
+    // transport of values read from INI file by the leader process to other processes
+    std::shared_ptr<transport>                                    transport_;
+    // node-local directory for resolved parameters shared by processes on the node
+    std::string                                                   node_snapshot_;
+    // socket of the server of values of INI files
+    std::string                                                   snapshot_server_;
+
+    // parameters in order of serialization (sorted by name) and hash of their names and types, updated after definitions
+    mutable std::vector<params_item*>                             schema_;
+    mutable std::uint64_t                                         schema_hash_ = 0;
+    // hash of resolved values of parameters
+    std::uint64_t                                                 hash_        = 0;
+
+    // flags of serialized parameters
+    static constexpr std::uint8_t                                 serialized_has_value  = 1;
+    static constexpr std::uint8_t                                 serialized_is_set     = 2;
+    // string value is the text of the typed value and is not stored
+    static constexpr std::uint8_t                                 serialized_typed_text = 4;
+
+    bool                                                          parse_arguments(int argc, char* argv[]) {
+      // values of the previous parse are dropped, so that they are taken from the new command line and INI file
+      if (parsed_) {
+        inifile_->restore(std::nullopt, "", false);
+        clear_values();
+      }
+      args_.parse(argc, argv, false);
+      parsed_ = true;
+      if (parameters_map_.empty() && argc > 2)
+        return false;  // we provided command line parameters but haven't defined any them yet
+      bool help_requested = build();
+      return !help_requested;
+    }
+
+    /**
+     * Drop values of all parameters, so that they are set again from command line and INI file
+     */
+    void clear_values() {
+      for (const auto& item : params_set_) item->entry()->restore(std::nullopt, "", false);
+    }
 
     inline bool                                                   build_internal() {
       bool help_requested = args_.build(false);
       if (help_requested) return true;
-      if (inifile_->has_value() && !inifile_->string_value().value().empty() &&
-          std::filesystem::exists(inifile_->string_value().value())) {
+      if (!transport_ && !node_snapshot_.empty()) {
+        build_node_snapshot();
+        return false;
+      }
+      std::string buffer;
+      if (!transport_ || transport_->is_leader()) buffer = read_inifile();
+      if (transport_) transport_->broadcast(buffer);
+      apply_inifile(buffer);
+      built_ = true;
+      hash_  = combine_hashes(value_hashes());
+      return false;
+    }
+
+    /**
+     * Load snapshot of resolved parameters from node-local directory, the process that takes the lock first creates it.
+     * Snapshot starts with the state of INI file and of the files it includes, snapshot of modified files is replaced.
+     */
+    void build_node_snapshot() {
+      std::string path = node_snapshot_ + "/green-params-" + std::to_string(snapshot_key());
+      auto        load = [this, &path]() {
+        std::string      snapshot;
+        std::string_view serialized;
+        if (!internal::read_file(path, snapshot) || !is_current(snapshot, serialized)) return false;
+        try {
+          deserialize(serialized);
+          return true;
+        } catch (const params_serialize_error&) {
+          // broken snapshot is replaced like a stale one, values restored from it are set again from command line
+          clear_values();
+          args_.build(false);
+          return false;
+        }
+      };
+      if (load()) return;
+      internal::file_lock lock(path + ".lock");
+      // snapshot may have been written while we were waiting for the lock
+      if (load()) return;
+      std::vector<std::string> files;
+      apply_inifile(read_inifile(&files));
+      built_ = true;
+      hash_  = combine_hashes(value_hashes());
+      internal::write_file(path, snapshot_header(files) + serialize());
+    }
+
+    /**
+     * Paths and states of `files` parameters have been read from, written at the beginning of node snapshot
+     */
+    static std::string snapshot_header(const std::vector<std::string>& files) {
+      std::string header;
+      internal::write_raw<std::uint64_t>(header, files.size());
+      for (const std::string& file : files) {
+        internal::file_state state = internal::state_of(file);
+        internal::write_string(header, file);
+        internal::write_raw(header, state.first);
+        internal::write_raw(header, state.second);
+      }
+      return header;
+    }
+
+    /**
+     * Check that files recorded in the header of node `snapshot` are not modified
+     *
+     * @param serialized - set to serialized parameters following the header
+     */
+    static bool is_current(std::string_view snapshot, std::string_view& serialized) {
+      try {
+        std::uint64_t files = internal::read_raw<std::uint64_t>(snapshot);
+        for (std::uint64_t i = 0; i < files; ++i) {
+          std::string          file(internal::read_string(snapshot));
+          internal::file_state state;
+          state.first  = internal::read_raw<std::int64_t>(snapshot);
+          state.second = internal::read_raw<std::uint64_t>(snapshot);
+          if (internal::state_of(file) != state) return false;
+        }
+      } catch (const params_serialize_error&) {
+        return false;
+      }
+      serialized = snapshot;
+      return true;
+    }
+
+    /**
+     * Hashes of names, types and typed values of parameters in the order of `schema`
+     */
+    std::vector<std::uint64_t> value_hashes() const {
+      const std::vector<params_item*>& items = schema();
+      std::vector<std::uint64_t>       hashes;
+      std::string                      buffer;
+      hashes.reserve(items.size());
+      for (const params_item* item : items) {
+        const argparse::Entry& entry = *item->entry();
+        buffer.clear();
+        internal::write_string(buffer, item->name());
+        internal::write_string(buffer, item->codec_->tag);
+        internal::write_raw<std::uint8_t>(buffer, entry.has_value());
+        internal::write_string(buffer, entry.get_error());
+        if (entry.has_value() && !entry.has_error()) item->codec_->write(buffer, entry);
+        hashes.push_back(internal::fnv1a(buffer));
+      }
+      return hashes;
+    }
+
+    static std::uint64_t combine_hashes(const std::vector<std::uint64_t>& hashes) {
+      std::uint64_t hash = internal::fnv1a("");
+      for (std::uint64_t h : hashes) hash = internal::fnv1a_raw(h, hash);
+      return hash;
+    }
+
+    /**
+     * Hash of everything that defines resolved parameters: serialization format, definitions, values from command line and
+     * absolute path of INI file (or INI text). Content of INI file is checked by `is_current`, so that snapshot of modified
+     * file is replaced instead of leaving a snapshot for every version of the file in the directory.
+     */
+    std::uint64_t snapshot_key() const {
+      const std::vector<params_item*>& items = schema();
+      std::uint64_t                    key   = internal::fnv1a_raw(schema_hash_, internal::fnv1a(""));
+      key                                    = internal::fnv1a_raw(serialize_version, key);
+      for (const params_item* item : items) {
+        if (!item->entry()->is_set()) continue;
+        key = internal::fnv1a(item->name(), key);
+        key = internal::fnv1a(std::string_view("\0", 1), key);
+        key = internal::fnv1a(item->entry()->string_value().value_or(""), key);
+        key = internal::fnv1a(std::string_view("\0", 1), key);
+      }
+      key = internal::fnv1a(case_insensitive_ ? "i" : "s", key);
+      if (ini_text_.has_value()) return internal::fnv1a(*ini_text_, key);
+      std::string inifile = inifile_->string_value().value_or("");
+      if (inifile.empty()) return internal::fnv1a(inifile, key);
+      // processes started from different directories share the snapshot of the same file
+      std::error_code ec;
+      std::string     path = std::filesystem::absolute(inifile, ec).string();
+      return internal::fnv1a(ec ? inifile : path, key);
+    }
+
+    /**
+     * Read values of parameters from INI file into a buffer that can be sent to other processes, parameters set in command
+     * line are skipped unless the buffer is sent through transport. Buffer starts with a status byte, that is followed
+     * either by names and values of parameters, each prefixed by its size, or by an error message.
+     *
+     * @param files - if not null, set to absolute paths of INI file and of files it includes, the file is read locally
+     */
+    std::string read_inifile(std::vector<std::string>* files = nullptr) const {
+      std::string buffer(1, internal::inifile_read);
+      bool        from_text = ini_text_.has_value();
+      int         flags     = INI_LOAD_LAZY | INI_LOAD_NO_COMMENTS | (case_insensitive_ ? INI_LOAD_FOLD_CASE : 0);
+      if (!from_text && files == nullptr && !snapshot_server_.empty() && inifile_->has_value() &&
+          !inifile_->string_value().value().empty()) {
+        std::error_code ec;
+        std::string     path = std::filesystem::absolute(inifile_->string_value().value(), ec).string();
+        if (!ec && internal::fetch_inifile(snapshot_server_, path, case_insensitive_, buffer)) return buffer;
+        buffer.assign(1, internal::inifile_read);
+      }
+      if (from_text || (inifile_->has_value() && !inifile_->string_value().value().empty() &&
+                        std::filesystem::exists(inifile_->string_value().value()))) {
         INI::File ft;
-        ft.Load(inifile_->string_value().value(), true);
+        if (from_text)
+          ft.LoadText(*ini_text_, true, "", flags);
+        else
+          ft.Load(inifile_->string_value().value(), true, flags);
+        if (files != nullptr && !from_text) {
+          files->push_back(inifile_->string_value().value());
+          for (const std::string& included : ft.IncludedFiles()) files->push_back(included);
+          for (std::string& file : *files) {
+            std::error_code ec;
+            std::string     path = std::filesystem::absolute(file, ec).string();
+            if (!ec) file = path;
+          }
+        }
         for (auto& [name, param] : parameters_map_) {
-          params_item& param_val = *param.get();
-          if (param_val.is_set()) continue;
+          // parameters set in command line of the leader can be missing in command lines of other processes, receivers
+          // skip the parameters they have set themselves
+          if (!transport_ && param->is_set()) continue;
           std::string parsed_name(name);
           std::replace(parsed_name.begin(), parsed_name.end(), '.', ':');
           INI::Value val = ft.GetValue(parsed_name);
           if (val.IsValid()) {
-            param_val.update_entry(val.AsString());
+            internal::append_field(buffer, name);
+            internal::append_field(buffer, val.View());
           }
         }
       } else if (inifile_->has_value() && !inifile_->string_value().value().empty()) {
-        throw params_inifile_error("First positional argument should be a name of a valid parameter INI file. " +
-                                                                                     inifile_->string_value().value());
+        buffer[0] = internal::inifile_failed;
+        buffer += "First positional argument should be a name of a valid parameter INI file. " + inifile_->string_value().value();
       }
-      built_ = true;
-      return false;
+      return buffer;
+    }
+
+    /**
+     * Update parameters, that are not set in command line, with values from the buffer created by `read_inifile`
+     */
+    void apply_inifile(std::string_view buffer) {
+      if (buffer.empty()) throw params_transport_error("Empty buffer of parameters");
+      if (buffer[0] == internal::inifile_failed) throw params_inifile_error(std::string(buffer.substr(1)));
+      buffer.remove_prefix(1);
+      std::string_view name;
+      std::string_view value;
+      while (internal::read_field(buffer, name)) {
+        if (!internal::read_field(buffer, value)) throw params_transport_error("Truncated buffer of parameters");
+        auto it = parameters_map_.find(std::string(name));
+        if (it == parameters_map_.end() || it->second->is_set()) continue;
+        it->second->update_entry(std::string(value));
+      }
+    }
+    /**
+     * Parameters sorted by name and hash of their names and types, computed once after parameters are defined
+     */
+    const std::vector<params_item*>& schema() const {
+      if (schema_.size() == params_set_.size()) return schema_;
+      schema_.clear();
+      for (const auto& item : params_set_) schema_.push_back(item.get());
+      std::sort(schema_.begin(), schema_.end(), [](const params_item* a, const params_item* b) { return a->name() < b->name(); });
+      schema_hash_ = internal::fnv1a("");
+      for (const params_item* item : schema_) {
+        schema_hash_ = internal::fnv1a(item->name(), schema_hash_);
+        schema_hash_ = internal::fnv1a(std::string_view("\0", 1), schema_hash_);
+        schema_hash_ = internal::fnv1a(item->codec_->tag, schema_hash_);
+        schema_hash_ = internal::fnv1a(std::string_view("\0", 1), schema_hash_);
+      }
+      return schema_;
     }
+
+    /**
+     * Names of the parameter as they are stored in the parameters map, case-folded once here for case-insensitive parameters
+     *
+     * @param name - comma-separated names of the parameter
+     */
+    std::vector<std::string> keys(const std::string& name) const {
+      std::vector<std::string> names = argparse::split(name);
+      if (case_insensitive_)
+        for (auto& n : names) n = argparse::to_lower(n);
+      return names;
+    }
+
     template <typename T>
     auto check_redefiniton(const std::vector<std::string>& names) {
       std::vector<std::string> new_names;
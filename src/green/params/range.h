@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_RANGE_H
+#define GREEN_PARAMS_RANGE_H
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+#include "except.h"
+
+namespace green::params {
+  /**
+   * Arithmetic progression parameter. Parsed from `start:stop:step` or `start:stop:<count>n` (e.g. `0:1:0.1` or `0:1:11n`),
+   * `stop` is included whenever it is hit by the progression. Only first element, step and number of elements are stored,
+   * elements are computed on access and the full list is materialized only by `to_vector()`.
+   *
+   * @tparam T - arithmetic type of elements
+   */
+  template <typename T>
+  class range {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "range is only defined for arithmetic types");
+
+  public:
+    using value_type = T;
+    using size_type  = size_t;
+
+    /**
+     * Random access iterator over elements of the range
+     */
+    class const_iterator {
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type        = T;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const T*;
+      using reference         = T;
+
+      const_iterator() = default;
+      const_iterator(const range* r, size_t i) : range_(r), i_(i) {}
+      T               operator*() const { return (*range_)[i_]; }
+      T               operator[](difference_type n) const { return (*range_)[i_ + n]; }
+      const_iterator& operator++() {
+        ++i_;
+        return *this;
+      }
+      const_iterator operator++(int) { return const_iterator(range_, i_++); }
+      const_iterator& operator--() {
+        --i_;
+        return *this;
+      }
+      const_iterator operator--(int) { return const_iterator(range_, i_--); }
+      const_iterator& operator+=(difference_type n) {
+        i_ += n;
+        return *this;
+      }
+      const_iterator& operator-=(difference_type n) {
+        i_ -= n;
+        return *this;
+      }
+      const_iterator  operator+(difference_type n) const { return const_iterator(range_, i_ + n); }
+      const_iterator  operator-(difference_type n) const { return const_iterator(range_, i_ - n); }
+      difference_type operator-(const const_iterator& rhs) const { return difference_type(i_) - difference_type(rhs.i_); }
+      bool            operator==(const const_iterator& rhs) const { return i_ == rhs.i_; }
+      bool            operator!=(const const_iterator& rhs) const { return i_ != rhs.i_; }
+      bool            operator<(const const_iterator& rhs) const { return i_ < rhs.i_; }
+      bool            operator>(const const_iterator& rhs) const { return i_ > rhs.i_; }
+      bool            operator<=(const const_iterator& rhs) const { return i_ <= rhs.i_; }
+      bool            operator>=(const const_iterator& rhs) const { return i_ >= rhs.i_; }
+
+    private:
+      const range* range_ = nullptr;
+      size_t       i_     = 0;
+    };
+
+    range() : start_(0), step_(0), size_(0) {}
+
+    /**
+     * Create range from its first element, step and number of elements
+     */
+    range(T start, T step, size_t size) : start_(start), step_(step), size_(size) {}
+
+    /**
+     * Parse range from string `start:stop:step`, `start:stop:<count>n` or `start:stop` (unit step)
+     *
+     * @param str - string representation of the range
+     */
+    explicit range(const std::string& str) {
+      std::string_view fields[3];
+      size_t           nfields = 0;
+      size_t           begin   = 0;
+      for (size_t pos = 0; pos <= str.size(); ++pos) {
+        if (pos != str.size() && str[pos] != ':') continue;
+        if (nfields == 3) throw params_convert_error("Too many fields in range '" + str + "'");
+        fields[nfields++] = internal::trim(std::string_view(str).substr(begin, pos - begin));
+        begin             = pos + 1;
+      }
+      if (nfields < 2)
+        throw params_convert_error("Range '" + str + "' should be given as start:stop:step or start:stop:<count>n");
+      T start = internal::parse_number<T>(fields[0], str);
+      T stop  = internal::parse_number<T>(fields[1], str);
+      if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(start) || !std::isfinite(stop))
+          throw params_convert_error("Range '" + str + "' has non-finite bounds");
+      }
+      start_ = start;
+      if (nfields == 3 && !fields[2].empty() && fields[2].back() == 'n') {
+        size_t count = internal::parse_number<size_t>(fields[2].substr(0, fields[2].size() - 1), str);
+        size_       = count;
+        step_       = 0;
+        if (count > 1) {
+          if constexpr (std::is_integral_v<T>) {
+            if ((stop - start) % T(count - 1) != 0)
+              throw params_convert_error("Range '" + str + "' can not be split into equal integer steps");
+          }
+          step_ = (stop - start) / T(count - 1);
+          if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(step_)) throw params_convert_error("Range '" + str + "' has non-finite step");
+          }
+        }
+        return;
+      }
+      step_ = nfields == 3 ? internal::parse_number<T>(fields[2], str) : T(1);
+      if (step_ == T(0)) throw params_convert_error("Range '" + str + "' has zero step");
+      if ((step_ > T(0) && stop < start) || (step_ < T(0) && stop > start)) {
+        size_ = 0;
+      } else if constexpr (std::is_integral_v<T>) {
+        // count in unsigned arithmetic, `stop - start` may overflow T
+        using U     = std::make_unsigned_t<T>;
+        U    span   = step_ > T(0) ? U(U(stop) - U(start)) : U(U(start) - U(stop));
+        U    stride = step_ > T(0) ? U(step_) : U(U(0) - U(step_));
+        auto count  = span / stride;
+        if (count >= std::numeric_limits<size_t>::max()) throw params_convert_error("Range '" + str + "' has too many elements");
+        size_ = size_t(count) + 1;
+      } else {
+        if (!std::isfinite(step_)) throw params_convert_error("Range '" + str + "' has non-finite step");
+        T span = (stop - start) / step_;
+        // tolerate round-off, so that 0:1:0.1 contains 1
+        T eps  = T(16) * std::numeric_limits<T>::epsilon() * std::max(T(1), std::abs(span));
+        T last = std::floor(span + eps);
+        // also rejects infinite span, e.g. when `stop - start` overflows T
+        if (!(last < T(std::numeric_limits<size_t>::max())))
+          throw params_convert_error("Range '" + str + "' has too many elements");
+        size_ = size_t(last) + 1;
+      }
+    }
+
+    [[nodiscard]] T      operator[](size_t i) const { return T(start_ + T(i) * step_); }
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool   empty() const { return size_ == 0; }
+    [[nodiscard]] T      start() const { return start_; }
+    [[nodiscard]] T      step() const { return step_; }
+    [[nodiscard]] T      front() const { return start_; }
+    [[nodiscard]] T      back() const { return (*this)[size_ - 1]; }
+    const_iterator       begin() const { return const_iterator(this, 0); }
+    const_iterator       end() const { return const_iterator(this, size_); }
+
+    /**
+     * @return all the elements of the range
+     */
+    [[nodiscard]] std::vector<T> to_vector() const {
+      std::vector<T> ret(size_);
+      for (size_t i = 0; i < size_; ++i) ret[i] = (*this)[i];
+      return ret;
+    }
+    explicit operator std::vector<T>() const { return to_vector(); }
+
+    bool     operator==(const range& rhs) const { return start_ == rhs.start_ && step_ == rhs.step_ && size_ == rhs.size_; }
+    bool     operator!=(const range& rhs) const { return !(*this == rhs); }
+
+    /**
+     * Print range in the form that is parsed back into the same range
+     */
+    friend std::ostream& operator<<(std::ostream& out, const range& r) {
+      out << internal::number_to_string(r.start_) << ":";
+      if (r.size_ > 1)
+        out << internal::number_to_string(r.back()) << ":" << internal::number_to_string(r.step_);
+      else
+        out << internal::number_to_string(r.start_) << ":" << r.size_ << "n";
+      return out;
+    }
+
+  private:
+    T      start_;
+    T      step_;
+    size_t size_;
+  };
+
+  namespace internal {
+    template <typename T>
+    struct is_range_t : std::false_type {};
+    template <typename T>
+    struct is_range_t<range<T>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_range_v = is_range_t<T>::value;
+  }  // namespace internal
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_RANGE_H
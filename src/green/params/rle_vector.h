@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_RLE_VECTOR_H
+#define GREEN_PARAMS_RLE_VECTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "common.h"
+#include "except.h"
+
+namespace green::params {
+  /**
+   * Run-length compressed array parameter. Parsed from comma-separated list of `value*count` runs or single values,
+   * e.g. `0*500,1*24,0.5*8`. Only runs are stored, full array is created only by `to_vector()`.
+   * Elements are accessed by position in amortized O(1) when positions are visited in order (the run of the last
+   * accessed element is remembered), and in O(log runs) otherwise. Iterators always advance in O(1).
+   *
+   * @tparam T - arithmetic type of elements
+   */
+  template <typename T>
+  class rle_vector {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "rle_vector is only defined for arithmetic types");
+
+  public:
+    using value_type = T;
+    using size_type  = size_t;
+
+    /**
+     * Forward iterator over elements, advances through runs in O(1)
+     */
+    class const_iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type        = T;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = const T*;
+      using reference         = const T&;
+
+      const_iterator() = default;
+      const_iterator(const rle_vector* v, size_t run, size_t i) : vec_(v), run_(run), i_(i) {}
+      const T&        operator*() const { return vec_->values_[run_]; }
+      const T*        operator->() const { return &vec_->values_[run_]; }
+      const_iterator& operator++() {
+        if (++i_ == vec_->ends_[run_]) ++run_;
+        return *this;
+      }
+      const_iterator operator++(int) {
+        const_iterator tmp = *this;
+        ++*this;
+        return tmp;
+      }
+      bool operator==(const const_iterator& rhs) const { return i_ == rhs.i_; }
+      bool operator!=(const const_iterator& rhs) const { return i_ != rhs.i_; }
+
+    private:
+      const rle_vector* vec_ = nullptr;
+      size_t            run_ = 0;
+      size_t            i_   = 0;
+    };
+
+    rle_vector() = default;
+
+    /**
+     * Parse array from string of comma-separated `value*count` runs
+     *
+     * @param str - string representation of the array
+     */
+    explicit rle_vector(const std::string& str) {
+      if (internal::trim(str).empty()) return;
+      size_t begin = 0;
+      for (size_t pos = 0; pos <= str.size(); ++pos) {
+        if (pos != str.size() && str[pos] != ',') continue;
+        std::string_view token = internal::trim(std::string_view(str).substr(begin, pos - begin));
+        size_t           star  = token.find('*');
+        if (star == std::string_view::npos) {
+          push_back(internal::parse_number<T>(token, str));
+        } else {
+          push_back(internal::parse_number<T>(internal::trim(token.substr(0, star)), str),
+                    internal::parse_number<size_t>(internal::trim(token.substr(star + 1)), str));
+        }
+        begin = pos + 1;
+      }
+    }
+
+    /**
+     * Append a run of `count` elements equal to `value`
+     */
+    void push_back(T value, size_t count = 1) {
+      if (count == 0) return;
+      if (!values_.empty() && values_.back() == value) {
+        ends_.back() += count;
+        return;
+      }
+      values_.push_back(value);
+      ends_.push_back(size() + count);
+    }
+
+    /**
+     * Access element by its position. O(1) if the element is in the run of the previously accessed element or in the
+     * next run, so sequential access is amortized O(1), otherwise binary search over runs in O(log runs).
+     */
+    [[nodiscard]] const T& operator[](size_t i) const {
+      size_t r    = cursor_.run.load(std::memory_order_relaxed);
+      // element is in the remembered run or in the next one
+      bool   near = r < runs() && i >= (r == 0 ? 0 : ends_[r - 1]) && (i < ends_[r] || (++r < runs() && i < ends_[r]));
+      if (!near) r = std::upper_bound(ends_.begin(), ends_.end(), i) - ends_.begin();
+      cursor_.run.store(r, std::memory_order_relaxed);
+      return values_[r];
+    }
+    [[nodiscard]] size_t   size() const { return ends_.empty() ? 0 : ends_.back(); }
+    [[nodiscard]] bool     empty() const { return ends_.empty(); }
+    /// number of stored runs
+    [[nodiscard]] size_t   runs() const { return values_.size(); }
+    /// value of the run `r`
+    [[nodiscard]] const T& run_value(size_t r) const { return values_[r]; }
+    /// number of elements in the run `r`
+    [[nodiscard]] size_t   run_length(size_t r) const { return ends_[r] - (r == 0 ? 0 : ends_[r - 1]); }
+    const_iterator         begin() const { return const_iterator(this, 0, 0); }
+    const_iterator         end() const { return const_iterator(this, runs(), size()); }
+
+    /**
+     * @return all the elements of the array
+     */
+    [[nodiscard]] std::vector<T> to_vector() const {
+      std::vector<T> ret;
+      ret.reserve(size());
+      for (size_t r = 0; r < runs(); ++r) ret.insert(ret.end(), run_length(r), values_[r]);
+      return ret;
+    }
+    explicit operator std::vector<T>() const { return to_vector(); }
+
+    bool     operator==(const rle_vector& rhs) const { return values_ == rhs.values_ && ends_ == rhs.ends_; }
+    bool     operator!=(const rle_vector& rhs) const { return !(*this == rhs); }
+
+    /**
+     * Print array in the compressed form
+     */
+    friend std::ostream& operator<<(std::ostream& out, const rle_vector& v) {
+      for (size_t r = 0; r < v.runs(); ++r) {
+        out << (r == 0 ? "" : ",") << internal::number_to_string(v.values_[r]);
+        if (v.run_length(r) > 1) out << "*" << v.run_length(r);
+      }
+      return out;
+    }
+
+  private:
+    // run of the last element accessed by position, only a hint: it is not copied and concurrent readers may overwrite it
+    struct cursor {
+      mutable std::atomic<size_t> run{0};
+      cursor() = default;
+      cursor(const cursor&) {}
+      cursor& operator=(const cursor&) { return *this; }
+    };
+
+    std::vector<T>      values_;
+    // index one past the last element of each run
+    std::vector<size_t> ends_;
+    cursor              cursor_;
+  };
+
+  namespace internal {
+    template <typename T>
+    struct is_rle_vector_t : std::false_type {};
+    template <typename T>
+    struct is_rle_vector_t<rle_vector<T>> : std::true_type {};
+    template <typename T>
+    constexpr bool is_rle_vector_v = is_rle_vector_t<T>::value;
+  }  // namespace internal
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_RLE_VECTOR_H
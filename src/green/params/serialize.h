@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_SERIALIZE_H
+#define GREEN_PARAMS_SERIALIZE_H
+
+#include <argparse/argparse.h>
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "common.h"
+#include "except.h"
+#include "matrix.h"
+#include "range.h"
+#include "rle_vector.h"
+
+namespace green::params {
+  /// version of the binary format of serialized parameters, changed whenever the format changes
+  constexpr std::uint32_t serialize_version = 3;
+
+  namespace internal {
+    /// first bytes of serialized parameters
+    constexpr std::string_view serialize_magic = "GPRM";
+
+    /**
+     * 64-bit FNV-1a hash of `data`, continues hashing from `hash`
+     */
+    inline std::uint64_t       fnv1a(std::string_view data, std::uint64_t hash = 14695981039346656037ull) {
+      for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+      }
+      return hash;
+    }
+
+    /**
+     * Number of leading bytes of trivially copyable V, that hold its value. x87 extended precision `long double` has
+     * 64-bit significand and takes 10 bytes, the remaining padding bytes are indeterminate and are neither hashed nor stored.
+     */
+    template <typename V>
+    constexpr size_t value_size() {
+      if constexpr (std::is_floating_point_v<V> && std::numeric_limits<V>::digits == 64)
+        return 10;
+      else
+        return sizeof(V);
+    }
+
+    /**
+     * Numbers of type E without padding, arrays of them are copied at once
+     */
+    template <typename E>
+    constexpr bool is_packed_number_v = std::is_arithmetic_v<E> && !std::is_same_v<E, bool> && value_size<E>() == sizeof(E);
+
+    /**
+     * FNV-1a hash of bytes of trivially copyable `value`
+     */
+    template <typename V>
+    std::uint64_t fnv1a_raw(const V& value, std::uint64_t hash) {
+      return fnv1a(std::string_view(reinterpret_cast<const char*>(&value), value_size<V>()), hash);
+    }
+
+    /**
+     * Append bytes of trivially copyable `value` to `out`
+     */
+    template <typename V>
+    void write_raw(std::string& out, const V& value) {
+      out.append(reinterpret_cast<const char*>(&value), value_size<V>());
+    }
+
+    /**
+     * Read `size` bytes from the beginning of `in` and remove them from it
+     */
+    inline const char* read_bytes(std::string_view& in, size_t size) {
+      if (in.size() < size) throw params_serialize_error("Truncated buffer of serialized parameters");
+      const char* data = in.data();
+      in.remove_prefix(size);
+      return data;
+    }
+
+    template <typename V>
+    V read_raw(std::string_view& in) {
+      V value{};
+      std::memcpy(&value, read_bytes(in, value_size<V>()), value_size<V>());
+      return value;
+    }
+
+    inline void write_string(std::string& out, std::string_view str) {
+      write_raw<std::uint64_t>(out, str.size());
+      out.append(str.data(), str.size());
+    }
+
+    inline std::string_view read_string(std::string_view& in) {
+      std::uint64_t size = read_raw<std::uint64_t>(in);
+      if (size > in.size()) throw params_serialize_error("Truncated buffer of serialized parameters");
+      return std::string_view(read_bytes(in, size), size);
+    }
+
+    /**
+     * Stable name of the type T of a parameter, that does not depend on the compiler
+     */
+    template <typename T>
+    std::string type_tag() {
+      if constexpr (std::is_same_v<T, bool>)
+        return "b";
+      else if constexpr (std::is_enum_v<T>) {
+        // values are stored as underlying integers, so that they have to mean the same enumerators
+        std::string tag = "e" + type_tag<std::underlying_type_t<T>>();
+#ifdef HAS_MAGIC_ENUM
+        tag += '{';
+        for (const auto& [value, name] : magic_enum::enum_entries<T>())
+          tag += std::string(name) + "=" + std::to_string(static_cast<std::underlying_type_t<T>>(value)) + ",";
+        tag += '}';
+#endif
+        return tag;
+      }
+      else if constexpr (std::is_floating_point_v<T>)
+        return "f" + std::to_string(sizeof(T));
+      else if constexpr (std::is_integral_v<T>)
+        return (std::is_signed_v<T> ? "i" : "u") + std::to_string(sizeof(T));
+      else if constexpr (std::is_same_v<T, std::string>)
+        return "s";
+      else if constexpr (is_vector_v<T>)
+        return "v" + type_tag<typename T::value_type>();
+      else if constexpr (is_array_v<T>)
+        return "a" + std::to_string(std::tuple_size_v<T>) + type_tag<typename T::value_type>();
+      else if constexpr (is_complex_v<T>)
+        return "c" + type_tag<typename T::value_type>();
+      else if constexpr (is_range_v<T>)
+        return "r" + type_tag<typename T::value_type>();
+      else if constexpr (is_rle_vector_v<T>)
+        return "l" + type_tag<typename T::value_type>();
+      else if constexpr (is_matrix_v<T>)
+        return "m" + type_tag<typename T::value_type>();
+      else
+        static_assert(!std::is_same_v<T, T>, "Parameter type can not be serialized");
+    }
+
+    /**
+     * Append binary representation of `value` to `out`. Contiguous arrays of numbers are copied at once.
+     */
+    template <typename T>
+    void write_value(std::string& out, const T& value) {
+      if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        write_raw(out, value);
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        write_string(out, value);
+      } else if constexpr (is_vector_v<T>) {
+        using E = typename T::value_type;
+        write_raw<std::uint64_t>(out, value.size());
+        if constexpr (is_packed_number_v<E>)
+          out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(E));
+        else
+          for (size_t i = 0; i < value.size(); ++i) write_value<E>(out, value[i]);
+      } else if constexpr (is_array_v<T>) {
+        for (const auto& element : value) write_value(out, element);
+      } else if constexpr (is_complex_v<T>) {
+        write_raw(out, value.real());
+        write_raw(out, value.imag());
+      } else if constexpr (is_range_v<T>) {
+        write_raw(out, value.start());
+        write_raw(out, value.step());
+        write_raw<std::uint64_t>(out, value.size());
+      } else if constexpr (is_rle_vector_v<T>) {
+        write_raw<std::uint64_t>(out, value.runs());
+        for (size_t r = 0; r < value.runs(); ++r) {
+          write_raw(out, value.run_value(r));
+          write_raw<std::uint64_t>(out, value.run_length(r));
+        }
+      } else if constexpr (is_matrix_v<T>) {
+        write_raw<std::uint64_t>(out, value.rows());
+        write_raw<std::uint64_t>(out, value.cols());
+        if constexpr (is_packed_number_v<typename T::value_type>)
+          out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(typename T::value_type));
+        else
+          for (const auto& element : value) write_raw(out, element);
+      }
+    }
+
+    /**
+     * Read `value` written by `write_value` from the beginning of `in` and remove it from the buffer
+     */
+    template <typename T>
+    void read_value(std::string_view& in, T& value) {
+      if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        value = read_raw<T>(in);
+      } else if constexpr (std::is_same_v<T, std::string>) {
+        value = read_string(in);
+      } else if constexpr (is_vector_v<T>) {
+        using E            = typename T::value_type;
+        std::uint64_t size = read_raw<std::uint64_t>(in);
+        // every element takes at least one byte, so that broken sizes are detected before allocation
+        if (size > in.size()) throw params_serialize_error("Truncated buffer of serialized parameters");
+        value.resize(size);
+        if constexpr (is_packed_number_v<E>) {
+          const char* data = read_bytes(in, size * sizeof(E));
+          if (size) std::memcpy(value.data(), data, size * sizeof(E));
+        } else {
+          for (size_t i = 0; i < size; ++i) {
+            E element;
+            read_value(in, element);
+            value[i] = std::move(element);
+          }
+        }
+      } else if constexpr (is_array_v<T>) {
+        for (auto& element : value) read_value(in, element);
+      } else if constexpr (is_complex_v<T>) {
+        using E = typename T::value_type;
+        E re    = read_raw<E>(in);
+        E im    = read_raw<E>(in);
+        value   = T(re, im);
+      } else if constexpr (is_range_v<T>) {
+        using E = typename T::value_type;
+        E start = read_raw<E>(in);
+        E step  = read_raw<E>(in);
+        value   = T(start, step, read_raw<std::uint64_t>(in));
+      } else if constexpr (is_rle_vector_v<T>) {
+        using E            = typename T::value_type;
+        std::uint64_t runs = read_raw<std::uint64_t>(in);
+        T             array;
+        for (size_t r = 0; r < runs; ++r) {
+          E value_r = read_raw<E>(in);
+          array.push_back(value_r, read_raw<std::uint64_t>(in));
+        }
+        value = std::move(array);
+      } else if constexpr (is_matrix_v<T>) {
+        using E            = typename T::value_type;
+        std::uint64_t rows = read_raw<std::uint64_t>(in);
+        std::uint64_t cols = read_raw<std::uint64_t>(in);
+        if (cols != 0 && rows > in.size() / value_size<E>() / cols)
+          throw params_serialize_error("Truncated buffer of serialized parameters");
+        T m(rows, cols);
+        if constexpr (is_packed_number_v<E>) {
+          const char* data = read_bytes(in, m.size() * sizeof(E));
+          if (!m.empty()) std::memcpy(m.data(), data, m.size() * sizeof(E));
+        } else {
+          for (auto& element : m) element = read_raw<E>(in);
+        }
+        value = std::move(m);
+      }
+    }
+
+    /**
+     * Shortest text of `value`, that is converted back to the same value: numbers, strings and vectors of numbers
+     *
+     * @return false if values of type T have no such text
+     */
+    template <typename T>
+    bool format_value(const T& value, std::string& text) {
+      if constexpr (std::is_same_v<T, std::string>) {
+        text = value;
+        return true;
+      } else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+        char buffer[64];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        if (ec != std::errc()) return false;
+        text.assign(buffer, end);
+        return true;
+      } else if constexpr (is_vector_v<T>) {
+        using E = typename T::value_type;
+        if constexpr (std::is_arithmetic_v<E> && !std::is_same_v<E, bool>) {
+          text.clear();
+          std::string element;
+          for (size_t i = 0; i < value.size(); ++i) {
+            if (!format_value(value[i], element)) return false;
+            if (i) text += ',';
+            text += element;
+          }
+          return true;
+        }
+        return false;
+      } else {
+        return false;
+      }
+    }
+
+    /**
+     * Binary serialization of values of parameters of one type, parameters keep pointer to the codec of their type
+     */
+    struct value_codec {
+      // stable name of the type
+      std::string tag;
+      void (*write)(std::string& out, const argparse::Entry& entry);
+      void (*read)(std::string_view& in, argparse::Entry& entry);
+      // text of the typed value, see `format_value`
+      bool (*format)(const argparse::Entry& entry, std::string& text);
+    };
+
+    template <typename T>
+    const value_codec* codec_of() {
+      static const value_codec codec{
+          type_tag<T>(), [](std::string& out, const argparse::Entry& entry) { write_value(out, entry.typed_value<T>()); },
+          [](std::string_view& in, argparse::Entry& entry) { read_value(in, entry.typed_value<T>()); },
+          [](const argparse::Entry& entry, std::string& text) { return format_value(entry.typed_value<T>(), text); }};
+      return &codec;
+    }
+  }  // namespace internal
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_SERIALIZE_H
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_SHARED_MEMORY_H
+#define GREEN_PARAMS_SHARED_MEMORY_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "except.h"
+
+namespace green::params {
+  /**
+   * Named POSIX shared-memory segment with a read-only snapshot of data, e.g. serialized parameters. The segment is created
+   * by one process on the node and attached by other processes, that map it read-only. The segment is removed when the
+   * object of the creating process is destroyed, processes that have already attached it keep their mapping.
+   */
+  class shared_segment {
+    // beginning of the segment, data is visible to other processes after `ready` is set
+    struct header {
+      std::atomic<std::uint32_t> ready;
+      std::uint64_t              size;
+    };
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Lock-free atomics are required in shared memory");
+    // data starts at a cache line boundary
+    static constexpr size_t data_offset = 64;
+
+  public:
+    shared_segment(const shared_segment&)            = delete;
+    shared_segment& operator=(const shared_segment&) = delete;
+    shared_segment(shared_segment&& rhs) noexcept :
+        name_(std::move(rhs.name_)), address_(std::exchange(rhs.address_, nullptr)), mapped_(std::exchange(rhs.mapped_, 0)),
+        owner_(std::exchange(rhs.owner_, false)) {}
+    shared_segment& operator=(shared_segment&& rhs) noexcept {
+      if (this != &rhs) {
+        release();
+        name_    = std::move(rhs.name_);
+        address_ = std::exchange(rhs.address_, nullptr);
+        mapped_  = std::exchange(rhs.mapped_, 0);
+        owner_   = std::exchange(rhs.owner_, false);
+      }
+      return *this;
+    }
+    ~shared_segment() { release(); }
+
+    /**
+     * Create segment and copy data into it. Segment left with the same name by a previous run is replaced.
+     *
+     * @param name - name of the segment, '/' is prepended if missing
+     * @param data - content of the segment
+     * @return owner of the segment
+     */
+    static shared_segment create(const std::string& name, std::string_view data) {
+      shared_segment segment(segment_name(name));
+      shm_unlink(segment.name_.c_str());
+      int fd = shm_open(segment.name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if (fd < 0)
+        throw params_shared_memory_error("Can not create shared memory segment " + segment.name_ + ": " + strerror(errno));
+      segment.owner_  = true;
+      segment.mapped_ = data_offset + data.size();
+      if (ftruncate(fd, off_t(segment.mapped_)) != 0) {
+        close(fd);
+        throw params_shared_memory_error("Can not resize shared memory segment " + segment.name_ + ": " + strerror(errno));
+      }
+      void* address = mmap(nullptr, segment.mapped_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (address == MAP_FAILED)
+        throw params_shared_memory_error("Can not map shared memory segment " + segment.name_ + ": " + strerror(errno));
+      segment.address_ = address;
+      header* h        = new (address) header{};
+      h->size          = data.size();
+      if (!data.empty()) std::memcpy(static_cast<char*>(address) + data_offset, data.data(), data.size());
+      h->ready.store(1, std::memory_order_release);
+      return segment;
+    }
+
+    /**
+     * Map segment created by `create` read-only. Waits until the segment is created and filled or until timeout expires.
+     *
+     * @param name - name of the segment, '/' is prepended if missing
+     * @param timeout - time to wait for the segment, by default segment has to exist already
+     * @return attached segment
+     */
+    static shared_segment attach(const std::string& name, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)) {
+      shared_segment segment(segment_name(name));
+      auto           deadline = std::chrono::steady_clock::now() + timeout;
+      while (!segment.try_attach()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+          throw params_shared_memory_error("Shared memory segment " + segment.name_ + " is not available");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return segment;
+    }
+
+    /**
+     * @return content of the segment
+     */
+    [[nodiscard]] std::string_view   data() const {
+      const header* h = static_cast<const header*>(address_);
+      return std::string_view(static_cast<const char*>(address_) + data_offset, h->size);
+    }
+
+    [[nodiscard]] const std::string& name() const { return name_; }
+
+    [[nodiscard]] bool               is_owner() const { return owner_; }
+
+  private:
+    explicit shared_segment(std::string name) : name_(std::move(name)) {}
+
+    static std::string segment_name(const std::string& name) { return name.empty() || name[0] != '/' ? "/" + name : name; }
+
+    /**
+     * Map segment if it exists and has been filled
+     */
+    bool               try_attach() {
+      int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+      if (fd < 0) {
+        if (errno == ENOENT) return false;
+        throw params_shared_memory_error("Can not open shared memory segment " + name_ + ": " + strerror(errno));
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || size_t(st.st_size) < data_offset) {
+        close(fd);
+        return false;
+      }
+      void* address = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (address == MAP_FAILED)
+        throw params_shared_memory_error("Can not map shared memory segment " + name_ + ": " + strerror(errno));
+      const header* h = static_cast<const header*>(address);
+      if (h->ready.load(std::memory_order_acquire) == 0 || data_offset + h->size > size_t(st.st_size)) {
+        munmap(address, size_t(st.st_size));
+        return false;
+      }
+      address_ = address;
+      mapped_  = size_t(st.st_size);
+      return true;
+    }
+
+    void release() {
+      if (address_ != nullptr) munmap(address_, mapped_);
+      if (owner_) shm_unlink(name_.c_str());
+      address_ = nullptr;
+      owner_   = false;
+    }
+
+    std::string name_;
+    void*       address_ = nullptr;
+    size_t      mapped_  = 0;
+    // creator of the segment removes it
+    bool        owner_   = false;
+  };
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_SHARED_MEMORY_H
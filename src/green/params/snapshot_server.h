@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_SNAPSHOT_SERVER_H
+#define GREEN_PARAMS_SNAPSHOT_SERVER_H
+
+#include <ini/iniparser.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "except.h"
+#include "file_lock.h"
+#include "transport.h"
+
+namespace green::params {
+  namespace internal {
+#ifdef MSG_NOSIGNAL
+    // closed connection is reported as an error instead of SIGPIPE
+    constexpr int socket_send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int socket_send_flags = 0;
+#endif
+    // requests contain only the name of INI file
+    constexpr size_t max_request_size = 1 << 16;
+
+    inline bool      write_all(int fd, const char* data, size_t size) {
+      while (size > 0) {
+        ssize_t n = send(fd, data, size, socket_send_flags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= size_t(n);
+      }
+      return true;
+    }
+
+    inline bool read_all(int fd, char* data, size_t size) {
+      while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= size_t(n);
+      }
+      return true;
+    }
+
+    /**
+     * Send `message` prefixed by its size through the socket
+     */
+    inline bool send_message(int fd, std::string_view message) {
+      std::uint64_t size = message.size();
+      return write_all(fd, reinterpret_cast<const char*>(&size), sizeof(size)) && write_all(fd, message.data(), message.size());
+    }
+
+    /**
+     * Receive message sent by `send_message`
+     *
+     * @return false if connection is closed, times out or message is larger than `max_size`
+     */
+    inline bool receive_message(int fd, std::string& message, size_t max_size = std::numeric_limits<size_t>::max()) {
+      std::uint64_t size;
+      if (!read_all(fd, reinterpret_cast<char*>(&size), sizeof(size)) || size > max_size) return false;
+      message.resize(size);
+      return read_all(fd, message.data(), size);
+    }
+
+    inline sockaddr_un socket_address(const std::string& path) {
+      sockaddr_un address{};
+      address.sun_family = AF_UNIX;
+      if (path.size() >= sizeof(address.sun_path)) throw params_server_error("Socket path is too long: " + path);
+      std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+      return address;
+    }
+
+    inline void set_socket_timeout(int fd, int seconds) {
+      timeval timeout{seconds, 0};
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+    /**
+     * Connect to Unix domain socket
+     *
+     * @return socket descriptor or -1 if nobody listens on the socket
+     */
+    inline int connect_socket(const std::string& path) {
+      sockaddr_un address = socket_address(path);
+      int         fd      = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0) return -1;
+      if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+      }
+      return fd;
+    }
+
+    /**
+     * Request values of INI file from `green-params-served` listening on `socket`
+     *
+     * @param socket - path of the socket of the server
+     * @param path - absolute path of INI file
+     * @param fold_case - load INI file with lower case names
+     * @param buffer - values of INI file in the format of the leader buffer of `transport`
+     * @return false if server is not available or can not read INI file
+     */
+    inline bool fetch_inifile(const std::string& socket, const std::string& path, bool fold_case, std::string& buffer) {
+      int fd = connect_socket(socket);
+      if (fd < 0) return false;
+      set_socket_timeout(fd, 10);
+      bool ok = send_message(fd, std::string(1, fold_case ? 1 : 0) + path) && receive_message(fd, buffer);
+      close(fd);
+      return ok && !buffer.empty() && buffer[0] == inifile_read;
+    }
+  }  // namespace internal
+
+  /**
+   * Server of pre-resolved values of INI files over a Unix domain socket. INI file is parsed once on the first request,
+   * later requests get cached values until the file or any of its included files is modified.
+   * Values are sent as names of parameters and their string values, so that clients only convert values of parameters
+   * they define.
+   */
+  class snapshot_server {
+    // resolved values of INI file and state of the files they have been read from
+    struct snapshot {
+      std::vector<std::pair<std::string, internal::file_state>> files;
+      std::string                                               buffer;
+    };
+
+  public:
+    /**
+     * Listen on Unix domain socket, socket left by a previous server is replaced
+     *
+     * @param socket - path of the socket
+     */
+    explicit snapshot_server(const std::string& socket) : socket_(socket) {
+      int running = internal::connect_socket(socket_);
+      if (running >= 0) {
+        close(running);
+        throw params_server_error("Server is already running on " + socket_);
+      }
+      unlink(socket_.c_str());
+      sockaddr_un address = internal::socket_address(socket_);
+      fd_                 = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd_ < 0) throw params_server_error("Can not create socket: " + std::string(strerror(errno)));
+      if (bind(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(fd_, SOMAXCONN) != 0) {
+        std::string error = strerror(errno);
+        close(fd_);
+        throw params_server_error("Can not listen on " + socket_ + ": " + error);
+      }
+    }
+    snapshot_server(const snapshot_server&)            = delete;
+    snapshot_server& operator=(const snapshot_server&) = delete;
+    ~snapshot_server() {
+      close(fd_);
+      unlink(socket_.c_str());
+    }
+
+    /**
+     * Serve clients until `stop` is set
+     */
+    void serve(const std::atomic<bool>& stop) {
+      while (!stop) serve_one(100);
+    }
+
+    /**
+     * Wait for a client and answer its request
+     *
+     * @param timeout - time to wait for a client in milliseconds
+     * @return true if a client has been served
+     */
+    bool serve_one(int timeout) {
+      pollfd fds{fd_, POLLIN, 0};
+      if (poll(&fds, 1, timeout) <= 0) return false;
+      int client = accept(fd_, nullptr, nullptr);
+      if (client < 0) return false;
+      // slow clients do not block the server for long
+      internal::set_socket_timeout(client, 1);
+      std::string request;
+      bool        ok = internal::receive_message(client, request, internal::max_request_size) && !request.empty() &&
+                internal::send_message(client, snapshot_of(request.substr(1), request[0] != 0));
+      close(client);
+      return ok;
+    }
+
+    /**
+     * Values of INI file in the format of the leader buffer of `transport`, loaded again if the file has been modified
+     *
+     * @param path - absolute path of INI file
+     * @param fold_case - load INI file with lower case names
+     */
+    const std::string& snapshot_of(const std::string& path, bool fold_case) {
+      snapshot& snap = snapshots_[std::make_pair(path, fold_case)];
+      if (!snap.files.empty() && is_current(snap)) return snap.buffer;
+      snap.files.clear();
+      snap.buffer.assign(1, internal::inifile_read);
+      INI::File ft;
+      if (!std::filesystem::is_regular_file(path) ||
+          !ft.Load(path, true, INI_LOAD_NO_COMMENTS | (fold_case ? INI_LOAD_FOLD_CASE : 0))) {
+        snap.buffer[0] = internal::inifile_failed;
+        snap.buffer += "Can not read INI file " + path;
+        return snap.buffer;
+      }
+      snap.files.emplace_back(path, internal::state_of(path));
+      for (const std::string& included : ft.IncludedFiles()) snap.files.emplace_back(included, internal::state_of(included));
+      const INI::File& file = ft;
+      for (auto sect = file.SectionsBegin(); sect != file.SectionsEnd(); ++sect) {
+        // parameters are looked up in sections named by all components of their names but the last one
+        const std::string& section = sect->first;
+        if (section.find('.') != std::string::npos) continue;
+        std::string prefix = section;
+        std::replace(prefix.begin(), prefix.end(), ':', '.');
+        if (!prefix.empty()) prefix += '.';
+        for (auto val = sect->second->ValuesBegin(); val != sect->second->ValuesEnd(); ++val) {
+          if (val->first.find('.') != std::string::npos) continue;
+          internal::append_field(snap.buffer, prefix + val->first);
+          internal::append_field(snap.buffer, val->second.View());
+        }
+      }
+      return snap.buffer;
+    }
+
+    [[nodiscard]] const std::string& socket() const { return socket_; }
+
+  private:
+    static bool is_current(const snapshot& snap) {
+      for (const auto& [path, state] : snap.files)
+        if (internal::state_of(path) != state) return false;
+      return true;
+    }
+
+    std::string                                      socket_;
+    int                                              fd_ = -1;
+    std::map<std::pair<std::string, bool>, snapshot> snapshots_;
+  };
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_SNAPSHOT_SERVER_H
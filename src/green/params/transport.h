@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2023 University of Michigan
+ *
+ */
+#ifndef GREEN_PARAMS_TRANSPORT_H
+#define GREEN_PARAMS_TRANSPORT_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef GREEN_PARAMS_MPI
+#include <mpi.h>
+#endif
+
+#include "except.h"
+
+namespace green::params {
+  /**
+   * Transport of resolved parameters from the leader process to all other processes (e.g. from rank 0 to all MPI ranks).
+   * Only the leader reads parameters INI file, other processes receive values of parameters as a single buffer.
+   */
+  class transport {
+  public:
+    virtual ~transport() = default;
+
+    /**
+     * @return true for the process that reads parameters and sends them to other processes
+     */
+    [[nodiscard]] virtual bool         is_leader() const = 0;
+
+    /**
+     * Send buffer of the leader to all processes. Collective operation, all processes have to call it in the same order.
+     *
+     * @param buffer - data to send on the leader, replaced by received data on other processes
+     */
+    virtual void                       broadcast(std::string& buffer) = 0;
+
+    /**
+     * Collect one value from every process. Collective operation, all processes have to call it in the same order.
+     *
+     * @param value - value of this process
+     * @return values of all processes in the order of their ranks
+     */
+    virtual std::vector<std::uint64_t> all_gather(std::uint64_t value) = 0;
+  };
+
+  /**
+   * Transport between threads of a single process, every thread uses its own endpoint of a group.
+   * Allows to test parameters of several processes without MPI.
+   */
+  class local_transport : public transport {
+    // state shared by all endpoints of a group
+    struct channel {
+      std::mutex                 mutex;
+      std::condition_variable    cond;
+      std::string                buffer;
+      size_t                     size     = 0;
+      // number of buffers sent by the leader
+      size_t                     sent     = 0;
+      // number of endpoints that have not received the last buffer yet
+      size_t                     pending  = 0;
+      // values of the current gathering, number of endpoints that have contributed to it and the last gathered values
+      std::vector<std::uint64_t> gathering;
+      size_t                     arrived  = 0;
+      size_t                     gathered = 0;
+      std::vector<std::uint64_t> result;
+    };
+
+  public:
+    /**
+     * Create group of endpoints, the first one is the leader
+     *
+     * @param size - number of endpoints
+     */
+    static std::vector<std::shared_ptr<transport>> group(size_t size) {
+      std::shared_ptr<channel> ch = std::make_shared<channel>();
+      ch->size                    = size;
+      std::vector<std::shared_ptr<transport>> endpoints;
+      ch->gathering.resize(size);
+      for (size_t i = 0; i < size; ++i) endpoints.push_back(std::shared_ptr<transport>(new local_transport(ch, i)));
+      return endpoints;
+    }
+
+    [[nodiscard]] bool         is_leader() const override { return rank_ == 0; }
+
+    void                       broadcast(std::string& buffer) override {
+      std::unique_lock<std::mutex> lock(channel_->mutex);
+      if (rank_ == 0) {
+        channel_->buffer  = buffer;
+        channel_->pending = channel_->size - 1;
+        ++channel_->sent;
+        channel_->cond.notify_all();
+        // the buffer is not replaced until every endpoint has received it
+        channel_->cond.wait(lock, [this] { return channel_->pending == 0; });
+      } else {
+        channel_->cond.wait(lock, [this] { return channel_->sent > received_; });
+        buffer = channel_->buffer;
+        ++received_;
+        if (--channel_->pending == 0) channel_->cond.notify_all();
+      }
+    }
+
+    std::vector<std::uint64_t> all_gather(std::uint64_t value) override {
+      std::unique_lock<std::mutex> lock(channel_->mutex);
+      size_t                       round = channel_->gathered;
+      channel_->gathering[rank_]         = value;
+      if (++channel_->arrived == channel_->size) {
+        // values of the finished gathering stay available until every endpoint contributes to the next one
+        channel_->result  = channel_->gathering;
+        channel_->arrived = 0;
+        ++channel_->gathered;
+        channel_->cond.notify_all();
+      } else {
+        channel_->cond.wait(lock, [this, round] { return channel_->gathered != round; });
+      }
+      return channel_->result;
+    }
+
+  private:
+    local_transport(std::shared_ptr<channel> ch, size_t rank) : channel_(std::move(ch)), rank_(rank) {}
+
+    std::shared_ptr<channel> channel_;
+    // the first endpoint is the leader
+    size_t                   rank_;
+    size_t                   received_ = 0;
+  };
+
+#ifdef GREEN_PARAMS_MPI
+  /**
+   * Transport between ranks of MPI communicator (enabled with GREEN_PARAMS_MPI). MPI has to be initialized before use.
+   */
+  class mpi_transport : public transport {
+  public:
+    /**
+     * @param comm - communicator of processes that share parameters
+     * @param root - rank of the leader
+     */
+    explicit mpi_transport(MPI_Comm comm = MPI_COMM_WORLD, int root = 0) : comm_(comm), root_(root) {}
+
+    [[nodiscard]] bool         is_leader() const override {
+      int rank;
+      MPI_Comm_rank(comm_, &rank);
+      return rank == root_;
+    }
+
+    void                       broadcast(std::string& buffer) override {
+      unsigned long long size = buffer.size();
+      MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG_LONG, root_, comm_);
+      buffer.resize(size);
+      // counts of MPI calls are int, large buffers are sent in pieces
+      constexpr size_t piece = std::numeric_limits<int>::max();
+      for (size_t offset = 0; offset < size; offset += piece)
+        MPI_Bcast(buffer.data() + offset, int(std::min<size_t>(piece, size - offset)), MPI_CHAR, root_, comm_);
+    }
+
+    std::vector<std::uint64_t> all_gather(std::uint64_t value) override {
+      int size;
+      MPI_Comm_size(comm_, &size);
+      std::vector<std::uint64_t> values(size);
+      MPI_Allgather(&value, 1, MPI_UINT64_T, values.data(), 1, MPI_UINT64_T, comm_);
+      return values;
+    }
+
+  private:
+    MPI_Comm comm_;
+    int      root_;
+  };
+#endif
+
+  namespace internal {
+    // first byte of the buffer with values read from INI file
+    constexpr char inifile_read   = 0;
+    constexpr char inifile_failed = 1;
+
+    /**
+     * Append `field` to `buffer` prefixed by its size
+     */
+    inline void append_field(std::string& buffer, std::string_view field) {
+      std::uint32_t size = static_cast<std::uint32_t>(field.size());
+      buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+      buffer.append(field.data(), field.size());
+    }
+
+    /**
+     * Read field written by `append_field` from the beginning of `buffer` and remove it from the buffer
+     *
+     * @return false if buffer is empty
+     */
+    inline bool read_field(std::string_view& buffer, std::string_view& field) {
+      if (buffer.empty()) return false;
+      std::uint32_t size;
+      if (buffer.size() < sizeof(size)) throw params_transport_error("Truncated buffer of parameters");
+      std::memcpy(&size, buffer.data(), sizeof(size));
+      buffer.remove_prefix(sizeof(size));
+      if (buffer.size() < size) throw params_transport_error("Truncated buffer of parameters");
+      field = buffer.substr(0, size);
+      buffer.remove_prefix(size);
+      return true;
+    }
+  }  // namespace internal
+}  // namespace green::params
+
+#endif  // GREEN_PARAMS_TRANSPORT_H
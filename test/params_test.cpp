@@ -87,6 +87,401 @@ TEST_CASE("Params") {
     REQUIRE(b == 345);
   }
 
+  SECTION("Parse Parameters from INI Text") {
+    auto        p    = green::params::params("DESCR");
+    std::string text = "AA = 123\nBB = 7\n[AAA]\nAA = 345 ; comment\n";
+    p.define<int>("AA", "value from text");
+    p.define<int>("BB", "value from command line");
+    p.define<int>("AAA.AA", "value from text section", 5);
+    p.parse("test --BB 8", text);
+    int  a = p["AA"];
+    int  b = p["BB"];
+    long c = p["AAA.AA"];
+    REQUIRE(a == 123);
+    REQUIRE(b == 8);
+    REQUIRE(c == 345);
+    // text is owned by parameters and outlives the caller's buffer, parameters are rebuilt after new definitions
+    auto owned = green::params::params("DESCR");
+    owned.define<int>("AA", "value from text");
+    owned.parse("test", std::string("AA = 1\nBB = 2\n"));
+    owned.define<int>("BB", "value defined after parsing");
+    int bb = owned["BB"];
+    REQUIRE(bb == 2);
+    // text is forgotten when parameters are parsed again without it
+    owned.parse("test "s + TEST_PATH + "/test.ini");
+    a = owned["AA"];
+    REQUIRE(a == 123);
+  }
+
+  SECTION("Broadcast Parameters") {
+    size_t                   nproc     = 4;
+    auto                     endpoints = green::params::local_transport::group(nproc);
+    std::vector<int>         a(nproc);
+    std::vector<long>        b(nproc);
+    std::vector<std::string> x(nproc);
+    std::vector<std::string> errors(nproc);
+    auto                     run = [&](size_t rank, const std::string& leader_file) {
+      try {
+        auto p = green::params::params("DESCR");
+        p.set_transport(endpoints[rank]);
+        // only the leader reads INI file, other processes would fail to open theirs
+        // each process takes values from its own command line and the rest from the file read by the leader
+        p.parse("test " + (rank == 0 ? leader_file + " --AA 7" : TEST_PATH + "/nonexisting.ini --AAA.AA 9"s));
+        p.define<int>("AA", "value from command line");
+        p.define<int>("AAA.AA", "value from file section", 5);
+        p.define<std::string>("STRING.X", "value from file");
+        a[rank] = p["AA"];
+        b[rank] = p["AAA.AA"];
+        x[rank] = p["STRING.X"].as<std::string>();
+      } catch (const std::exception& e) {
+        errors[rank] = e.what();
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t rank = 0; rank < nproc; ++rank) threads.emplace_back(run, rank, TEST_PATH + "/test.ini"s);
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) {
+      REQUIRE(errors[rank].empty());
+      REQUIRE(a[rank] == (rank == 0 ? 7 : 123));
+      REQUIRE(b[rank] == (rank == 0 ? 345 : 9));
+      REQUIRE(x[rank] == "123456");
+    }
+    // failure to read INI file on the leader is reported by all processes
+    threads.clear();
+    for (size_t rank = 0; rank < nproc; ++rank) threads.emplace_back(run, rank, TEST_PATH + "/nonexisting.ini"s);
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) REQUIRE(errors[rank].find("valid parameter INI file") != std::string::npos);
+  }
+
+  SECTION("Serialize Parameters") {
+    std::string text   = "N = 4\nBETA = 10.5\nNAME = run\nGRID = 0.5,1,2\nMU = (0.5,-1)\nNK = 2,2,1\nTAU = 0:1:11n\n"
+                         "OCC = 1*3,0*2\nLAT = {1,0},{0,1}\nCOLOR = yellow\nDEBUG = true\nEPS = 1e-3\n"
+                         "LBETA = 0.1\nLMU = (0.1,-0.3)\nLGRID = 0.1,0.2\nLLAT = {0.1,0.2}\n";
+    auto        define = [](green::params::params& p) {
+      p.define<int>("N", "integer");
+      p.define<double>("BETA,B", "real");
+      p.define<double>("EPS", "real in other notation than its shortest text");
+      p.define<std::string>("NAME", "string");
+      p.define<std::vector<double>>("GRID", "vector");
+      p.define<std::complex<double>>("MU", "complex");
+      p.define<std::array<int, 3>>("NK", "array");
+      p.define<green::params::range<double>>("TAU", "range");
+      p.define<green::params::rle_vector<int>>("OCC", "run-length compressed array");
+      p.define<green::params::matrix<double>>("LAT", "matrix");
+      p.define<myenum>("COLOR", "enum");
+      p.define<bool>("DEBUG", "flag");
+      p.define<long double>("LBETA", "extended precision real");
+      p.define<std::complex<long double>>("LMU", "extended precision complex");
+      p.define<std::vector<long double>>("LGRID", "extended precision vector");
+      p.define<green::params::matrix<long double>>("LLAT", "extended precision matrix");
+      p.define<int>("DEF", "default value", 3);
+      p.define<int>("MISSING", "required value");
+    };
+    auto p = green::params::params("DESCR");
+    define(p);
+    p.parse("test --N 5", text);
+    std::string buffer = p.serialize();
+    auto        q      = green::params::params("DESCR");
+    define(q);
+    q.deserialize(buffer);
+    REQUIRE(int(q["N"]) == 5);
+    REQUIRE(double(q["B"]) == 10.5);
+    REQUIRE(q["NAME"].as<std::string>() == "run");
+    REQUIRE(q["GRID"].as<std::vector<double>>() == std::vector<double>{0.5, 1, 2});
+    REQUIRE(q["MU"].as<std::complex<double>>() == std::complex<double>(0.5, -1));
+    REQUIRE(q["NK"].as<std::array<int, 3>>() == std::array<int, 3>{2, 2, 1});
+    REQUIRE(q["TAU"].as<green::params::range<double>>() == p["TAU"].as<green::params::range<double>>());
+    REQUIRE(q["OCC"].as<green::params::rle_vector<int>>() == p["OCC"].as<green::params::rle_vector<int>>());
+    REQUIRE(q["LAT"].as<green::params::matrix<double>>() == p["LAT"].as<green::params::matrix<double>>());
+    REQUIRE(q["COLOR"].as<myenum>() == YELLOW);
+    REQUIRE(q["DEBUG"].as<bool>());
+    REQUIRE(q["LBETA"].as<long double>() == p["LBETA"].as<long double>());
+    REQUIRE(q["LMU"].as<std::complex<long double>>() == p["LMU"].as<std::complex<long double>>());
+    REQUIRE(q["LGRID"].as<std::vector<long double>>() == p["LGRID"].as<std::vector<long double>>());
+    REQUIRE(q["LLAT"].as<green::params::matrix<long double>>() == p["LLAT"].as<green::params::matrix<long double>>());
+    // enumerations are only compatible if their enumerators are the same
+    REQUIRE(green::params::internal::type_tag<myenum>().find("YELLOW=2") != std::string::npos);
+    REQUIRE(int(q["DEF"]) == 3);
+    REQUIRE(q["N"].as<std::string>() == "5");
+    REQUIRE(q["BETA"].as<std::string>() == "10.5");
+    REQUIRE(q["EPS"].as<std::string>() == "1e-3");
+    REQUIRE(q.is_set("N"));
+    REQUIRE_FALSE(q.is_set("DEF"));
+    REQUIRE_THROWS_AS(q["MISSING"], green::params::params_value_error);
+    REQUIRE(q.serialize() == buffer);
+    // restored parameters can not be used with different definitions or broken buffers
+    auto r = green::params::params("DESCR");
+    define(r);
+    r.define<int>("EXTRA", "not serialized", 1);
+    REQUIRE_THROWS_AS(r.deserialize(buffer), green::params::params_serialize_error);
+    REQUIRE_THROWS_AS(q.deserialize(buffer.substr(0, buffer.size() - 1)), green::params::params_serialize_error);
+    REQUIRE_THROWS_AS(q.deserialize("not parameters"), green::params::params_serialize_error);
+  }
+
+  SECTION("Consistency Check") {
+    auto p = green::params::params("DESCR");
+    p.define<double>("BETA", "value from text");
+    p.define<int>("N", "value from command line", 4);
+    p.parse("test --N 4", "BETA = 10.0\n");
+    auto q = green::params::params("DESCR");
+    q.define<int>("N", "default value", 4);
+    q.define<double>("BETA", "value from text");
+    q.parse("test", "BETA = 1e1\n");
+    q["N"];
+    // the same resolved values have the same hash
+    REQUIRE(p.hash() == q.hash());
+    q.parse("test --BETA 1");
+    q["N"];
+    REQUIRE(p.hash() != q.hash());
+    // padding bytes of extended precision values do not change the hash
+    auto extended = [](const std::string& args, std::string_view text) {
+      auto e = green::params::params("DESCR");
+      e.define<long double>("LBETA", "extended precision real");
+      e.define<std::complex<long double>>("LMU", "extended precision complex");
+      e.parse(args, text);
+      e["LBETA"];
+      return e.hash();
+    };
+    REQUIRE(extended("test", "LBETA = 0.1\nLMU = (0.1,-0.3)\n") == extended("test --LBETA 0.1 --LMU 0.1,-0.3", ""));
+    REQUIRE(extended("test", "LBETA = 0.1\nLMU = (0.1,-0.3)\n") != extended("test --LBETA 0.2 --LMU 0.1,-0.3", ""));
+
+    size_t                   nproc     = 4;
+    auto                     endpoints = green::params::local_transport::group(nproc);
+    std::vector<std::string> errors(nproc);
+    auto                     run       = [&](size_t rank, const std::string& args) {
+      try {
+        auto r = green::params::params("DESCR");
+        r.set_transport(endpoints[rank]);
+        r.define<double>("BETA", "value from file");
+        r.define<int>("AA", "value from file");
+        r.define<long double>("LBETA", "extended precision value from command line");
+        r.define<std::complex<long double>>("LMU", "extended precision value from command line");
+        r.parse(args + " --LBETA 0.1 --LMU 0.1,-0.3 " + TEST_PATH + "/test.ini");
+        r["AA"];
+        r.check_consistency(*endpoints[rank]);
+      } catch (const std::exception& e) {
+        errors[rank] = e.what();
+      }
+    };
+    std::vector<std::thread> threads;
+    for (size_t rank = 0; rank < nproc; ++rank) threads.emplace_back(run, rank, "test --BETA 2");
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) REQUIRE(errors[rank].empty());
+    // process with a different command line is reported by all processes
+    threads.clear();
+    for (size_t rank = 0; rank < nproc; ++rank) threads.emplace_back(run, rank, rank == 2 ? "test --BETA 3" : "test --BETA 2");
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) {
+      REQUIRE(errors[rank].find("leader: 2.") != std::string::npos);
+      REQUIRE(errors[rank].find("'BETA'") != std::string::npos);
+    }
+    // transport without a leader is reported instead of waiting for the broadcast of the leader
+    struct leaderless : green::params::transport {
+      explicit leaderless(std::shared_ptr<green::params::transport> tr) : tr_(std::move(tr)) {}
+      bool                       is_leader() const override { return false; }
+      void                       broadcast(std::string& buffer) override { tr_->broadcast(buffer); }
+      std::vector<std::uint64_t> all_gather(std::uint64_t value) override { return tr_->all_gather(value); }
+      std::shared_ptr<green::params::transport> tr_;
+    };
+    endpoints = green::params::local_transport::group(nproc);
+    threads.clear();
+    for (size_t rank = 0; rank < nproc; ++rank) {
+      threads.emplace_back([&, rank]() {
+        try {
+          auto r = green::params::params("DESCR");
+          r.define<double>("BETA", "value from command line");
+          r.parse(rank == 2 ? "test --BETA 3" : "test --BETA 2");
+          r["BETA"];
+          leaderless tr(endpoints[rank]);
+          r.check_consistency(tr);
+        } catch (const green::params::params_transport_error& e) {
+          errors[rank] = e.what();
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) REQUIRE(errors[rank].find("exactly one leader") != std::string::npos);
+  }
+
+  SECTION("Shared Memory Parameters") {
+    std::string name   = "green_params_test_" + std::to_string(getpid());
+    auto        define = [](green::params::params& p) {
+      p.define<int>("AA", "value from command line");
+      p.define<std::vector<double>>("GRID", "value from text");
+      p.define<std::string>("NAME", "default value", "run");
+    };
+    auto p = green::params::params("DESCR");
+    define(p);
+    p.parse("test --AA 7", "GRID = 0.5,1,2\n");
+    std::vector<int>         a(4);
+    std::vector<std::string> errors(4);
+    // processes may attach before the segment is published
+    std::vector<std::thread> threads;
+    for (size_t rank = 0; rank < a.size(); ++rank) {
+      threads.emplace_back([&, rank]() {
+        try {
+          auto q = green::params::params("DESCR");
+          define(q);
+          q.attach(name, std::chrono::seconds(10));
+          a[rank] = q["AA"];
+        } catch (const std::exception& e) {
+          errors[rank] = e.what();
+        }
+      });
+    }
+    {
+      green::params::shared_segment segment = p.publish(name);
+      for (auto& t : threads) t.join();
+      for (size_t rank = 0; rank < a.size(); ++rank) {
+        REQUIRE(errors[rank].empty());
+        REQUIRE(a[rank] == 7);
+      }
+      auto q = green::params::params("DESCR");
+      define(q);
+      q.attach(name);
+      REQUIRE(q["GRID"].as<std::vector<double>>() == std::vector<double>{0.5, 1, 2});
+      REQUIRE(q["NAME"].as<std::string>() == "run");
+      REQUIRE(q.is_set("AA"));
+    }
+    // segment is removed with its owner
+    auto q = green::params::params("DESCR");
+    define(q);
+    REQUIRE_THROWS_AS(q.attach(name), green::params::params_shared_memory_error);
+  }
+
+  SECTION("Node Snapshot Parameters") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / ("green_params_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    size_t                   nproc = 4;
+    std::vector<long>        b(nproc);
+    std::vector<std::string> x(nproc);
+    std::vector<std::string> errors(nproc);
+    auto                     run = [&](size_t rank) {
+      try {
+        auto p = green::params::params("DESCR");
+        p.set_node_snapshot(dir.string());
+        p.parse("test "s + TEST_PATH + "/test.ini --AA 7");
+        p.define<int>("AA", "value from command line");
+        p.define<int>("AAA.AA", "value from file section", 5);
+        p.define<std::string>("STRING.X", "value from file");
+        b[rank] = p["AAA.AA"];
+        x[rank] = p["STRING.X"].as<std::string>();
+      } catch (const std::exception& e) {
+        errors[rank] = e.what();
+      }
+    };
+    auto snapshots = [&dir]() {
+      size_t count = 0;
+      for (const auto& file : std::filesystem::directory_iterator(dir))
+        if (file.path().extension() != ".lock") ++count;
+      return count;
+    };
+    std::vector<std::thread> threads;
+    for (size_t rank = 0; rank < nproc; ++rank) threads.emplace_back(run, rank);
+    for (auto& t : threads) t.join();
+    for (size_t rank = 0; rank < nproc; ++rank) {
+      REQUIRE(errors[rank].empty());
+      REQUIRE(b[rank] == 345);
+      REQUIRE(x[rank] == "123456");
+    }
+    // INI file has been read once for the full set of definitions, later runs load the same snapshot
+    size_t count = snapshots();
+    run(0);
+    REQUIRE(errors[0].empty());
+    REQUIRE(b[0] == 345);
+    REQUIRE(snapshots() == count);
+    // broken snapshot is replaced like a stale one
+    for (const auto& file : std::filesystem::directory_iterator(dir))
+      if (file.path().extension() != ".lock") std::filesystem::resize_file(file.path(), file.file_size() - 1);
+    run(0);
+    REQUIRE(errors[0].empty());
+    REQUIRE(b[0] == 345);
+    REQUIRE(x[0] == "123456");
+    run(1);
+    REQUIRE(errors[1].empty());
+    REQUIRE(b[1] == 345);
+    REQUIRE(snapshots() == count);
+    // modification of included file is detected, snapshot of modified files replaces the previous one
+    std::filesystem::path inputs = std::filesystem::temp_directory_path() / ("green_params_input_" + std::to_string(getpid()));
+    std::filesystem::create_directories(inputs);
+    std::ofstream((inputs / "main.ini").string()) << "[AAA]\n;#include values.ini\n";
+    std::ofstream((inputs / "values.ini").string()) << "AA = 1\n";
+    auto included = [&]() {
+      auto p = green::params::params("DESCR");
+      p.set_node_snapshot(dir.string());
+      p.parse("test " + (inputs / "main.ini").string());
+      p.define<int>("AAA.AA", "value from included file");
+      return int(p["AAA.AA"]);
+    };
+    REQUIRE(included() == 1);
+    count = snapshots();
+    std::ofstream((inputs / "values.ini").string()) << "AA = 22\n";
+    REQUIRE(included() == 22);
+    REQUIRE(included() == 22);
+    REQUIRE(snapshots() == count);
+    std::filesystem::remove_all(inputs);
+    std::filesystem::remove_all(dir);
+  }
+
+  SECTION("Snapshot Server") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / ("green_params_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    std::string socket  = (dir / "served.sock").string();
+    std::string inifile = (dir / "test.ini").string();
+    std::ofstream(inifile) << "AA = 1\n[AAA]\nAA = 2\n";
+    auto run = [&]() {
+      auto p = green::params::params("DESCR");
+      p.set_snapshot_server(socket);
+      p.parse("test " + inifile + " --BB 3");
+      p.define<int>("AA", "value from file");
+      p.define<int>("AAA.AA", "value from file section");
+      p.define<int>("BB", "value from command line");
+      return std::array<int, 3>{p["AA"], p["AAA.AA"], p["BB"]};
+    };
+    {
+      green::params::snapshot_server server(socket);
+      REQUIRE_THROWS_AS(green::params::snapshot_server(socket), green::params::params_server_error);
+      std::atomic<bool> stop(false);
+      std::thread       t([&]() { server.serve(stop); });
+      REQUIRE(run() == std::array<int, 3>{1, 2, 3});
+      std::string buffer;
+      REQUIRE(green::params::internal::fetch_inifile(socket, inifile, false, buffer));
+      // modified INI file is loaded again by the server
+      std::ofstream(inifile) << "AA = 10\n[AAA]\nAA = 20\n";
+      REQUIRE(run() == std::array<int, 3>{10, 20, 3});
+      stop = true;
+      t.join();
+      REQUIRE(server.snapshot_of(inifile, false)[0] == green::params::internal::inifile_read);
+      REQUIRE(server.snapshot_of((dir / "nonexisting.ini").string(), false)[0] == green::params::internal::inifile_failed);
+    }
+    // INI file is parsed locally without the server
+    REQUIRE_FALSE(std::filesystem::exists(socket));
+    REQUIRE(run() == std::array<int, 3>{10, 20, 3});
+    std::filesystem::remove_all(dir);
+  }
+
+  SECTION("Case-Insensitive Parameters") {
+    auto        p    = green::params::params("DESCR", true);
+    std::string text = "Beta = 1.5\n[SOLVER]\nNiter = 10\nTol = 1e-3\n";
+    p.define<double>("BETA", "value from text");
+    p.define<int>("solver.niter", "value from text section");
+    p.define<double>("Solver.TOL,eps", "value from command line");
+    p.parse("test --EPS 1e-5", text);
+    double beta  = p["beta"];
+    int    niter = p["SOLVER.NITER"];
+    double tol   = p["solver.tol"];
+    REQUIRE(beta == 1.5);
+    REQUIRE(niter == 10);
+    REQUIRE(tol == 1e-5);
+    REQUIRE(p.is_set("Eps"));
+    auto exact = green::params::params("DESCR");
+    exact.define<double>("BETA", "case-sensitive value", 2.0);
+    exact.parse("test --beta 3", text);
+    double exact_beta = exact["BETA"];
+    REQUIRE(exact_beta == 2.0);
+    REQUIRE_THROWS_AS(exact["beta"], green::params::params_notfound_error);
+  }
+
   SECTION("Nonexisting Argument") {
     auto        p    = green::params::params("DESCR");
     std::string args = "test --a 33";
@@ -337,4 +732,512 @@ TEST_CASE("Params") {
     std::vector<myenum> a;
     REQUIRE_THROWS_AS(a = p["a"], green::params::params_value_error);
   }
+  SECTION("Complex and Array Types") {
+    auto        p       = green::params::params("DESCR");
+    std::string inifile = TEST_PATH + "/test.ini"s;
+    std::string args    = "test " + inifile + " --shift 0.1,2 --kmesh 2 3 --bad 1,2,3";
+    p.define<std::complex<double>>("PHYS.MU", "chemical potential");
+    p.define<std::complex<double>>("shift", "complex shift");
+    p.define<std::array<int, 3>>("PHYS.NK", "k-mesh");
+    p.define<std::array<int, 2>>("kmesh", "2d k-mesh");
+    p.define<std::array<int, 2>>("bad", "wrong number of elements");
+    p.define<std::array<double, 2>>("def", "default", std::array<double, 2>{1.5, 2.5});
+    p.parse(args);
+    std::complex<double>  mu    = p["PHYS.MU"];
+    std::complex<double>  shift = p["shift"];
+    std::array<int, 3>    nk    = p["PHYS.NK"];
+    std::array<int, 2>    kmesh = p["kmesh"];
+    std::array<double, 2> def   = p["def"];
+    std::array<int, 2>    bad;
+    REQUIRE(mu == std::complex<double>(0.5, -1.25));
+    REQUIRE(shift == std::complex<double>(0.1, 2));
+    REQUIRE(nk == std::array<int, 3>{4, 4, 2});
+    REQUIRE(kmesh == std::array<int, 2>{2, 3});
+    REQUIRE(def == std::array<double, 2>{1.5, 2.5});
+    REQUIRE_THROWS_AS(bad = p["bad"], green::params::params_value_error);
+    REQUIRE_THROWS_AS(bad = p["PHYS.NK"], green::params::params_convert_error);
+  }
+  SECTION("Range Type") {
+    auto        p       = green::params::params("DESCR");
+    std::string inifile = TEST_PATH + "/test.ini"s;
+    std::string args    = "test " + inifile + " --iters 10:0:-2 --grid=-1:1:5n --bad 0:1:0 --huge 0:1e300:1e-300 --nan 0:nan:1";
+    p.define<green::params::range<double>>("PHYS.FREQ", "frequencies");
+    p.define<green::params::range<int>>("iters", "iteration schedule");
+    p.define<green::params::range<double>>("grid", "grid by number of points");
+    p.define<green::params::range<double>>("bad", "zero step");
+    p.define<green::params::range<double>>("huge", "too many elements");
+    p.define<green::params::range<double>>("nan", "non-finite bound");
+    p.define<green::params::range<long>>("def", "default", green::params::range<long>(1, 1, 3));
+    p.parse(args);
+    green::params::range<double> freq  = p["PHYS.FREQ"];
+    green::params::range<int>    iters = p["iters"];
+    green::params::range<double> grid  = p["grid"];
+    green::params::range<long>   def   = p["def"];
+    green::params::range<double> bad;
+    REQUIRE(freq.size() == 11);
+    REQUIRE(freq[10] == 1.0);
+    REQUIRE(iters.size() == 6);
+    REQUIRE(iters.back() == 0);
+    REQUIRE(std::vector<int>(iters.begin(), iters.end()) == std::vector<int>{10, 8, 6, 4, 2, 0});
+    REQUIRE(grid.to_vector() == std::vector<double>{-1, -0.5, 0, 0.5, 1});
+    REQUIRE(def.to_vector() == std::vector<long>{1, 2, 3});
+    REQUIRE(green::params::range<double>(argparse::toString(freq)) == freq);
+    REQUIRE(green::params::range<int>("5:1:1").empty());
+    REQUIRE_THROWS_AS(bad = p["bad"], green::params::params_value_error);
+    REQUIRE_THROWS_AS(bad = p["huge"], green::params::params_value_error);
+    REQUIRE_THROWS_AS(bad = p["nan"], green::params::params_value_error);
+    REQUIRE_THROWS_AS(green::params::range<double>("0:inf:3n"), green::params::params_convert_error);
+    REQUIRE_THROWS_AS(green::params::range<double>("-1e308:1e308:1"), green::params::params_convert_error);
+    REQUIRE_THROWS_AS(green::params::range<double>("-1e308:1e308:3n"), green::params::params_convert_error);
+    REQUIRE(green::params::range<int>("-2147483648:2147483647:65536").size() == 65536);
+  }
+  SECTION("Run-Length Compressed Array Type") {
+    auto        p       = green::params::params("DESCR");
+    std::string inifile = TEST_PATH + "/test.ini"s;
+    std::string args    = "test " + inifile + " --mask 0*500 1*24 1*6 --bad 1*x";
+    p.define<green::params::rle_vector<double>>("PHYS.OCC", "occupations");
+    p.define<green::params::rle_vector<int>>("mask", "mask");
+    p.define<green::params::rle_vector<int>>("bad", "bad count");
+    p.parse(args);
+    green::params::rle_vector<double> occ  = p["PHYS.OCC"];
+    green::params::rle_vector<int>    mask = p["mask"];
+    green::params::rle_vector<int>    bad;
+    REQUIRE(occ.to_vector() == std::vector<double>{1, 1, 1, 0.5, 0.5, 0});
+    REQUIRE(mask.size() == 530);
+    REQUIRE(mask.runs() == 2);
+    REQUIRE(mask[499] == 0);
+    REQUIRE(mask[500] == 1);
+    REQUIRE(mask[529] == 1);
+    // sequential and backward access through the remembered run
+    std::vector<int> seq;
+    for (size_t i = 0; i < mask.size(); ++i) seq.push_back(mask[i]);
+    REQUIRE(seq == mask.to_vector());
+    REQUIRE(mask[3] == 0);
+    REQUIRE(occ[5] == 0);
+    REQUIRE(occ[0] == 1);
+    REQUIRE(occ[4] == 0.5);
+    REQUIRE(std::count(mask.begin(), mask.end(), 1) == 30);
+    REQUIRE(argparse::toString(mask) == "0*500,1*30");
+    REQUIRE_THROWS_AS(bad = p["bad"], green::params::params_value_error);
+  }
+  SECTION("Matrix Type") {
+    auto        p       = green::params::params("DESCR");
+    std::string inifile = TEST_PATH + "/test.ini"s;
+    std::string args    = "test " + inifile + " --proj {1,2} {3,4} {5,6} --row 1,2,3 --bad {1,2},{3}";
+    p.define<green::params::matrix<double>>("PHYS.LATTICE", "lattice vectors");
+    p.define<green::params::matrix<int>>("proj", "projection");
+    p.define<green::params::matrix<int>>("row", "single row");
+    p.define<green::params::matrix<int>>("bad", "ragged rows");
+    p.parse(args);
+    green::params::matrix<double> lat  = p["PHYS.LATTICE"];
+    green::params::matrix<int>    proj = p["proj"];
+    green::params::matrix<int>    row  = p["row"];
+    green::params::matrix<int>    bad;
+    REQUIRE(lat.rows() == 3);
+    REQUIRE(lat.cols() == 3);
+    REQUIRE(lat(2, 2) == 2.5);
+    REQUIRE(lat.row(1)[1] == 1.0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(lat.data()) % green::params::matrix<double>::alignment == 0);
+    REQUIRE(proj.rows() == 3);
+    REQUIRE(proj.cols() == 2);
+    REQUIRE(proj.stride() == 2);
+    REQUIRE(std::vector<int>(proj.begin(), proj.end()) == std::vector<int>{1, 2, 3, 4, 5, 6});
+    REQUIRE(row.rows() == 1);
+    REQUIRE(row.cols() == 3);
+    REQUIRE(green::params::matrix<int>(argparse::toString(proj)) == proj);
+    REQUIRE_THROWS_AS(bad = p["bad"], green::params::params_value_error);
+  }
+}
+
+TEST_CASE("INI") {
+  SECTION("Value Conversion") {
+    INI::Value v(0.1);
+    REQUIRE(v.AsDouble() == 0.1);
+    REQUIRE(INI::Value(1.0 / 3.0).AsDouble() == 1.0 / 3.0);
+    REQUIRE(INI::Value(-1234567890123LL).Get<long long>() == -1234567890123LL);
+    REQUIRE(INI::Value("  +42").AsInt() == 42);
+    REQUIRE(INI::Value("12abc").AsInt() == 12);
+    REQUIRE(INI::Value("abc").AsInt() == 0);
+    // numbers out of range are clamped and reported by TryGet
+    REQUIRE(INI::Value("99999999999").AsInt() == std::numeric_limits<int>::max());
+    REQUIRE(INI::Value("-99999999999").AsInt() == std::numeric_limits<int>::min());
+    REQUIRE(INI::Value("1e400").AsDouble() == std::numeric_limits<double>::max());
+    REQUIRE(INI::Value("-1e400").AsDouble() == -std::numeric_limits<double>::max());
+    REQUIRE(INI::Value("1e-400").AsDouble() == 0);
+    int      i;
+    unsigned u;
+    double   d;
+    REQUIRE(INI::Value(" 42 ").TryGet(i));
+    REQUIRE(i == 42);
+    REQUIRE_FALSE(INI::Value("99999999999").TryGet(i));
+    REQUIRE(i == std::numeric_limits<int>::max());
+    REQUIRE_FALSE(INI::Value("-5").TryGet(u));
+    REQUIRE(u == 0);
+    REQUIRE_FALSE(INI::Value("12abc").TryGet(i));
+    REQUIRE_FALSE(INI::Value("abc").TryGet(i));
+    REQUIRE_FALSE(INI::Value("1e400").TryGet(d));
+    REQUIRE(INI::Value("1e-3").TryGet(d));
+    REQUIRE(INI::Value("1e-3").AsDouble() == 1e-3);
+    REQUIRE(INI::Value(true).AsString() == "true");
+    for (auto s : {"1", "t", "T", "y", "Y", "true", "Yes"}) REQUIRE(INI::Value(s).AsBool());
+    for (auto s : {"", "0", "f", "no", "false"}) REQUIRE_FALSE(INI::Value(s).AsBool());
+    REQUIRE(INI::Value("1, {2}, 3").AsVector<int>() == std::vector<int>{1, 2, 3});
+    REQUIRE(INI::Value("0.5,1e-3").AsVector<double>() == std::vector<double>{0.5, 1e-3});
+    REQUIRE(INI::Value("a, {b, c}, d\\}").AsArray().GetValue(1).AsString() == "b, c");
+    REQUIRE(INI::Value("a, {b, c}, d\\}").AsArray().GetValue(2).AsString() == "d}");
+    INI::Map map = INI::Value("x:1, y:{2,3}").AsMap();
+    REQUIRE(map.Size() == 2);
+    REQUIRE(map.GetValue("y").AsVector<int>() == std::vector<int>{2, 3});
+  }
+
+  SECTION("Value Storage") {
+    INI::Value small("short");
+    INI::Value large(std::string(100, 'x'));
+    INI::Value copy = large;
+    REQUIRE(copy.View().data() == large.View().data());
+    copy = small;
+    REQUIRE(copy == small);
+    REQUIRE(copy.View().data() != small.View().data());
+    INI::Value moved(std::move(large));
+    REQUIRE(moved.AsString() == std::string(100, 'x'));
+    REQUIRE(INI::Value("").IsValid());
+    REQUIRE_FALSE(INI::Value().IsValid());
+  }
+
+  SECTION("Load From Buffer") {
+    std::string   inifile = TEST_PATH + "/full.ini"s;
+    std::ifstream stream(inifile);
+    INI::File     from_stream;
+    INI::File     from_file;
+    INI::File     from_mmap;
+    REQUIRE(from_stream.Load(stream, true, TEST_PATH));
+    REQUIRE(from_file.Load(inifile));
+    REQUIRE(from_mmap.Load(inifile, true, INI_LOAD_MMAP));
+    std::stringstream s1, s2, s3;
+    from_stream.Save(s1);
+    from_file.Save(s2);
+    from_mmap.Save(s3);
+    REQUIRE(s1.str() == s2.str());
+    REQUIRE(s1.str() == s3.str());
+    REQUIRE(from_mmap.GetValue("GLOBAL").AsInt() == 1);
+    REQUIRE(from_mmap.GetValue("solver:tol").AsDouble() == 1e-8);
+    REQUIRE(from_mmap.GetValue("solver:method").AsString() == "dyson");
+    REQUIRE(from_mmap.GetValue("solver:grid").AsArray().ToVector<int>() == std::vector<int>{1, 2, 3, 4});
+    REQUIRE(from_mmap.GetValue("solver:niter").AsInt() == 100);
+    REQUIRE(from_mmap.GetValue("solver.sub:included").AsBool());
+    REQUIRE(from_mmap.GetValue("incsection:x").AsInt() == 42);
+    REQUIRE(from_mmap.FindSection("solver")->Comment() == "comment of the first section\ncomment of repeated section");
+    REQUIRE(from_mmap.FindSection("solver")->GetComment("tol") == "comment of tol");
+    INI::Value v = from_mmap.GetValue("solver:method");
+    from_mmap.SetValue("solver:method", "gw");
+    REQUIRE(v.AsString() == "dyson");
+    REQUIRE(from_mmap.GetValue("solver:method").AsString() == "gw");
+    INI::File bad;
+    REQUIRE_FALSE(bad.Load(TEST_PATH + "/nonexisting.ini"s));
+    REQUIRE(bad.LastResult().error_code == INI_ERR_INVALID_FILENAME);
+  }
+
+  SECTION("Fold Case") {
+    std::string text = "Beta = 1\n[Solver.SUB]\nNiter = 2\n[solver]\nTOL = 3\n";
+    for (int flags : {INI_LOAD_DEFAULT, INI_LOAD_LAZY, INI_LOAD_PARALLEL}) {
+      INI::File ft;
+      REQUIRE(ft.LoadText(text, true, "", flags | INI_LOAD_FOLD_CASE));
+      REQUIRE(ft.GetValue("beta").AsInt() == 1);
+      REQUIRE(ft.GetValue("solver.sub:niter").AsInt() == 2);
+      REQUIRE(ft.GetValue("solver:tol").AsInt() == 3);
+      REQUIRE(ft.FindParentSection(ft.FindSection("solver.sub")) == ft.FindSection("solver"));
+      REQUIRE_FALSE(ft.GetValue("Beta").IsValid());
+    }
+  }
+
+  SECTION("Load From Text") {
+    std::string text = "x = 1\n[s]\nlong = " + std::string(40, 'a') + "\nv = 1, 2 ; comment\n";
+    INI::File   ft;
+    REQUIRE(ft.LoadText(text));
+    REQUIRE(ft.GetValue("x").AsInt() == 1);
+    REQUIRE(ft.GetValue("s:v").AsVector<int>() == std::vector<int>{1, 2});
+    REQUIRE(ft.FindSection("s")->GetComment("v") == "comment");
+    // long values refer to the text until they are detached
+    INI::Value value = ft.GetValue("s:long");
+    REQUIRE(value.View().data() >= text.data());
+    REQUIRE(value.View().data() < text.data() + text.size());
+    value.Detach();
+    REQUIRE(value.AsString() == std::string(40, 'a'));
+    REQUIRE((value.View().data() < text.data() || value.View().data() >= text.data() + text.size()));
+    INI::File lazy;
+    REQUIRE(lazy.LoadText(text.data(), text.size(), true, "", INI_LOAD_LAZY));
+    REQUIRE(lazy.GetValue("s:long") == ft.GetValue("s:long"));
+    REQUIRE_FALSE(lazy.LoadText("[s\n"));
+    REQUIRE(lazy.LastResult().error_code == INI_ERR_PARSING_ERROR);
+  }
+
+  SECTION("Lazy Load") {
+    std::string text = "A = 1\n; first\n[s1]\nx = 1 ; x comment\ny = 2, \\\n 3\n\n; second\n[s2]\nx = 2\n[s1]\nz = 3\n";
+    std::stringstream eager_stream(text);
+    std::stringstream lazy_stream(text);
+    INI::File         eager;
+    INI::File         lazy;
+    REQUIRE(eager.Load(eager_stream));
+    REQUIRE(lazy.Load(lazy_stream, true, "", INI_LOAD_LAZY));
+    REQUIRE(lazy.SectionsSize() == 3);
+    REQUIRE(lazy.GetValue("s2:x").AsInt() == 2);
+    REQUIRE(lazy.GetValue("s1:y").AsString() == "2, 3");
+    REQUIRE(lazy.GetValue("s1:z").AsInt() == 3);
+    REQUIRE(lazy.FindSection("s1")->GetComment("x") == "x comment");
+    REQUIRE(lazy.FindSection("s2")->Comment() == "second");
+    std::stringstream s1, s2;
+    eager.Save(s1);
+    lazy.Save(s2);
+    REQUIRE(s1.str() == s2.str());
+    // files with inclusions are parsed at once
+    std::string inifile = TEST_PATH + "/full.ini"s;
+    INI::File   full;
+    REQUIRE(full.Load(inifile, true, INI_LOAD_LAZY | INI_LOAD_MMAP));
+    REQUIRE(full.GetValue("incsection:x").AsInt() == 42);
+    REQUIRE(full.GetValue("solver:niter").AsInt() == 100);
+  }
+
+  SECTION("Load Without Comments") {
+    std::string inifile = TEST_PATH + "/full.ini"s;
+    INI::File   with_comments(inifile);
+    INI::File   no_comments;
+    REQUIRE(no_comments.Load(inifile, true, INI_LOAD_NO_COMMENTS));
+    for (auto name : {"GLOBAL", "solver:tol", "solver:method", "solver:grid", "solver.sub:value", "incsection:x"})
+      REQUIRE(no_comments.GetValue(name) == with_comments.GetValue(name));
+    REQUIRE(no_comments.FindSection("solver")->Comment().empty());
+    REQUIRE(no_comments.FindSection("solver")->GetComment("tol").empty());
+    REQUIRE(with_comments.FindSection("solver")->GetComment("tol") == "comment of tol");
+  }
+
+  SECTION("Typed Load") {
+    std::stringstream text("i = 42\nbig = 3000000000\nd = 0.1\nz = -0\nv = 1, 2, 3\nw = 1, 0.5\ns = 12abc\nm = 1, a\n");
+    INI::File         typed;
+    REQUIRE(typed.Load(text, true, "", INI_LOAD_TYPED));
+    for (auto name : {"i", "big", "d", "z", "v", "w"}) REQUIRE(typed.GetValue(name).IsTyped());
+    for (auto name : {"s", "m"}) REQUIRE_FALSE(typed.GetValue(name).IsTyped());
+    REQUIRE(typed.GetValue("i").AsInt() == 42);
+    REQUIRE(typed.GetValue("i").AsDouble() == 42.0);
+    REQUIRE(typed.GetValue("i").AsString() == "42");
+    REQUIRE(typed.GetValue("big").AsInt() == std::numeric_limits<int>::max());
+    REQUIRE(typed.GetValue("big").Get<long long>() == 3000000000LL);
+    REQUIRE(typed.GetValue("big").Get<unsigned short>() == std::numeric_limits<unsigned short>::max());
+    REQUIRE(typed.GetValue("d").AsDouble() == 0.1);
+    REQUIRE(typed.GetValue("d").Get<float>() == 0.1f);
+    REQUIRE(typed.GetValue("d").AsInt() == 0);
+    REQUIRE(std::signbit(typed.GetValue("z").AsDouble()));
+    REQUIRE(typed.GetValue("v").AsVector<int>() == std::vector<int>{1, 2, 3});
+    REQUIRE(typed.GetValue("v").AsVector<double>() == std::vector<double>{1, 2, 3});
+    REQUIRE(typed.GetValue("w").AsVector<double>() == std::vector<double>{1, 0.5});
+    REQUIRE(typed.GetValue("w").AsVector<int>() == std::vector<int>{1, 0});
+    REQUIRE(typed.GetValue("s").AsInt() == 12);
+    REQUIRE(typed.GetValue("m").AsVector<int>() == std::vector<int>{1, 0});
+    // new text drops the converted numbers
+    INI::Value v = typed.GetValue("i");
+    v.Set("7");
+    REQUIRE_FALSE(v.IsTyped());
+    REQUIRE(v.AsInt() == 7);
+  }
+
+  SECTION("Patch") {
+    std::string fname = (std::filesystem::temp_directory_path() / "green_params_patch.ini").string();
+    {
+      std::ofstream out(fname);
+      out << "; header\nA = 1\n\n[s1] ; section comment\nx = 1 ; x comment\ny = 2\n\n[s2]\nz = 3\n";
+    }
+    INI::File mapped;
+    REQUIRE(mapped.Load(fname, true, INI_LOAD_MMAP));
+    INI::File file(fname);
+    file.SetValue("s1:x", 10);
+    file.SetValue("s2:w", "new");
+    file.SetValue("s3:v", 5);
+    file.FindSection("s1")->RemoveValue("y");
+    REQUIRE(file.Patch(fname));
+    std::ifstream in(fname);
+    std::string   patched((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    REQUIRE(patched == "; header\nA = 1\n\n[s1] ; section comment\nx = 10 ; x comment\n\n[s2]\nz = 3\nw = new\n\n[s3]\nv = 5\n");
+    INI::File reloaded(fname);
+    REQUIRE(reloaded.GetValue("s1:x").AsInt() == 10);
+    REQUIRE_FALSE(reloaded.GetValue("s1:y").IsValid());
+    // file is replaced, text mapped before patching is not modified
+    REQUIRE(mapped.GetValue("s1:x").AsInt() == 1);
+    REQUIRE(mapped.GetValue("s1:y").AsInt() == 2);
+    // names of file loaded with lower case names are compared in lower case
+    {
+      std::ofstream out(fname);
+      out << "[Sect]\nValue = 1\n";
+    }
+    INI::File folded;
+    REQUIRE(folded.Load(fname, true, INI_LOAD_FOLD_CASE));
+    folded.SetValue("sect:value", 2);
+    REQUIRE(folded.Patch(fname));
+    std::ifstream folded_in(fname);
+    REQUIRE(std::string((std::istreambuf_iterator<char>(folded_in)), std::istreambuf_iterator<char>()) == "[Sect]\nValue = 2\n");
+    std::filesystem::remove(fname);
+  }
+
+  SECTION("Parallel Load") {
+    std::string text = "A = 1\n";
+    for (int i = 0; i < 20000; ++i) {
+      std::string n = std::to_string(i % 1000);
+      text += "; comment " + n + "\n[section" + n + "]\nx = " + std::to_string(i) + "\ntable = 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, \\\n";
+      text += "11, 12, 13, 14, 15, 16, 17, 18, 19, 20 ; table comment\n\n";
+    }
+    std::stringstream sequential_stream(text);
+    std::stringstream parallel_stream(text);
+    INI::File         sequential;
+    INI::File         parallel;
+    REQUIRE(sequential.Load(sequential_stream));
+    REQUIRE(parallel.Load(parallel_stream, true, "", INI_LOAD_PARALLEL));
+    REQUIRE(parallel.GetValue("section7:x").AsInt() == 19007);
+    REQUIRE(parallel.FindSection("section7")->Comment().size() == 20 * std::string("comment 7\n").size() - 1);
+    std::stringstream s1, s2;
+    sequential.Save(s1);
+    parallel.Save(s2);
+    REQUIRE(s1.str() == s2.str());
+  }
+
+  SECTION("Section Tree") {
+    std::string       text = "A = 1\n[atom]\nn = 2\n[atom.1]\nx = 0\n[atom.1.basis]\nb = sto\n[atom.2]\nx = 1\n[atomic]\ny = 2\n";
+    std::stringstream stream(text);
+    INI::File         file;
+    REQUIRE(file.Load(stream, true, "", INI_LOAD_LAZY));
+    INI::Section* atom = file.FindSection("atom");
+    REQUIRE(atom->FindSubSection("1.basis")->GetValue("b").AsString() == "sto");
+    REQUIRE(atom->FindSubSection("3") == NULL);
+    REQUIRE(file.FindSection("atom.1.basis")->FindParent() == file.FindSection("atom.1"));
+    REQUIRE(atom->FindParent() == file.FindSection(""));
+    // only subsections of the section itself are found, not the ones of sections with the same prefix
+    INI::SectionVector subs = atom->FindSubSections();
+    REQUIRE(subs.size() == 3);
+    REQUIRE(subs[0]->FullName() == "atom.1");
+    REQUIRE(subs[1]->FullName() == "atom.1.basis");
+    REQUIRE(subs[2]->GetValue("x").AsInt() == 1);
+    REQUIRE(file.GetTopLevelSections().size() == 3);
+    // default section is the parent of top-level sections, all other sections are its subsections
+    INI::SectionVector all = file.FindSection("")->FindSubSections();
+    REQUIRE(all.size() == 5);
+    REQUIRE(all[0]->FullName() == "atom");
+    REQUIRE(all[4]->FullName() == "atomic");
+    REQUIRE(file.FindSubSections(file.FindSection("")).size() == 5);
+    file.DeleteSection("atom.1");
+    REQUIRE(atom->FindSubSections().size() == 2);
+    REQUIRE(file.FindSection("atom.1.basis")->GetParent()->FullName() == "atom.1");
+    REQUIRE(file.FindSection("atom.1")->ValuesSize() == 0);
+    file.DeleteSection("atom.1.basis");
+    file.DeleteSection("atom.1");
+    REQUIRE(atom->FindSubSection("1") == NULL);
+    REQUIRE(file.GetSubSection(atom, "1.basis")->FindParent() == NULL);
+  }
+
+  SECTION("Copy On Write") {
+    std::string text = "A = 1\n";
+    for (int i = 0; i < 100; ++i) text += "[s" + std::to_string(i) + "]\nx = " + std::to_string(i) + "\n";
+    std::stringstream stream(text);
+    INI::File         file;
+    REQUIRE(file.Load(stream, true, "", INI_LOAD_LAZY));
+    const INI::File& original = file;
+    const INI::File  copy(file);
+    REQUIRE(copy.FindSection("s1") == original.FindSection("s1"));
+    INI::File modified(file);
+    modified.SetValue("s1:x", 10);
+    modified.DeleteSection("s2");
+    REQUIRE(modified.FindSection("s1") != original.FindSection("s1"));
+    REQUIRE(original.GetValue("s1:x").AsInt() == 1);
+    REQUIRE(original.FindSection("s2") != NULL);
+    REQUIRE(modified.GetValue("s1:x").AsInt() == 10);
+    REQUIRE(modified.GetValue("s3:x").AsInt() == 3);
+    // sections reached through subsections or parents of a copy are its own
+    INI::File tree;
+    REQUIRE(tree.LoadText("[a]\nx = 1\n[a.b]\ny = 2\n"));
+    const INI::File& tree_original = tree;
+    INI::File        tree_copy(tree);
+    tree_copy.FindSubSection(tree_original.FindSection("a"), "b")->SetValue("y", 20);
+    tree_copy.FindParentSection(tree_original.FindSection("a.b"))->SetValue("x", 10);
+    tree_copy.FindSubSections(tree_original.FindSection("a"))[0]->SetValue("z", 3);
+    REQUIRE(tree_original.GetValue("a.b:y").AsInt() == 2);
+    REQUIRE(tree_original.GetValue("a:x").AsInt() == 1);
+    REQUIRE_FALSE(tree_original.GetValue("a.b:z").IsValid());
+    REQUIRE(tree_copy.GetValue("a.b:y").AsInt() == 20);
+    REQUIRE(tree_copy.GetValue("a:x").AsInt() == 10);
+    // sections created through a section of the file, that has been copied since, are added to the file only
+    INI::Section* section = tree.FindSection("a");
+    INI::File     later_copy(tree);
+    section->GetSubSection("c")->SetValue("w", 4);
+    REQUIRE(tree.GetValue("a.c:w").AsInt() == 4);
+    REQUIRE(later_copy.FindSection("a.c") == NULL);
+    // copies keep the load flags, names of a copy of a file loaded with lower case names are compared in lower case
+    std::string fname = (std::filesystem::temp_directory_path() / "green_params_copy.ini").string();
+    {
+      std::ofstream out(fname);
+      out << "[Sect]\nValue = 1\n";
+    }
+    INI::File folded;
+    REQUIRE(folded.Load(fname, true, INI_LOAD_FOLD_CASE));
+    INI::File folded_copy(folded);
+    folded_copy.SetValue("sect:value", 2);
+    REQUIRE(folded_copy.Patch(fname));
+    INI::File folded_assigned;
+    folded_assigned = folded;
+    folded_assigned.SetValue("sect:other", 3);
+    REQUIRE(folded_assigned.Patch(fname));
+    std::ifstream folded_in(fname);
+    REQUIRE(std::string((std::istreambuf_iterator<char>(folded_in)), std::istreambuf_iterator<char>()) ==
+            "[Sect]\nValue = 1\nother = 3\n");
+    std::filesystem::remove(fname);
+    // lazily loaded sections are parsed by concurrent readers
+    std::vector<std::thread> readers;
+    std::atomic<int>         errors(0);
+    for (int t = 0; t < 4; ++t) {
+      readers.emplace_back([&copy, &errors, t]() {
+        for (int i = 0; i < 100; ++i)
+          if (copy.GetValue("s" + std::to_string((i + 25 * t) % 100) + ":x").AsInt() != (i + 25 * t) % 100) ++errors;
+      });
+    }
+    for (size_t t = 0; t < readers.size(); ++t) readers[t].join();
+    REQUIRE(errors == 0);
+  }
+
+  SECTION("Include Cache") {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "green_params_include";
+    std::filesystem::create_directories(dir);
+    {
+      std::ofstream((dir / "main.ini").string()) << "[a]\n;#include basis.ini\n[b]\n;#include basis.ini\n;#include pseudo.ini\n";
+      std::ofstream((dir / "basis.ini").string()) << "basis = sto-3g\n";
+      std::ofstream((dir / "pseudo.ini").string()) << "pseudo = gth\n";
+    }
+    INI::File file;
+    REQUIRE(file.Load((dir / "main.ini").string()));
+    REQUIRE(file.GetValue("a:basis").AsString() == "sto-3g");
+    REQUIRE(file.GetValue("b:basis").AsString() == "sto-3g");
+    REQUIRE(file.GetValue("b:pseudo").AsString() == "gth");
+    // modified include is read again
+    std::ofstream((dir / "basis.ini").string()) << "basis = cc-pvdz\n";
+    REQUIRE(file.Load((dir / "main.ini").string()));
+    REQUIRE(file.GetValue("a:basis").AsString() == "cc-pvdz");
+    // include replaced by a file with the same size and modification time is read again
+    auto mtime = std::filesystem::last_write_time(dir / "basis.ini");
+    std::ofstream((dir / "replaced.ini").string()) << "basis = cc-pvtz\n";
+    std::filesystem::last_write_time(dir / "replaced.ini", mtime);
+    std::filesystem::rename(dir / "replaced.ini", dir / "basis.ini");
+    REQUIRE(file.Load((dir / "main.ini").string()));
+    REQUIRE(file.GetValue("a:basis").AsString() == "cc-pvtz");
+    // least recently used includes are dropped from the cache
+    size_t limit = INI::File::SetIncludeCacheLimit(1);
+    REQUIRE(INI::File::IncludeCacheSize() == 1);
+    REQUIRE(file.Load((dir / "main.ini").string()));
+    REQUIRE(INI::File::IncludeCacheSize() == 1);
+    REQUIRE(file.GetValue("b:pseudo").AsString() == "gth");
+    INI::File::SetIncludeCacheLimit(0);
+    REQUIRE(INI::File::IncludeCacheSize() == 0);
+    REQUIRE(file.Load((dir / "main.ini").string()));
+    REQUIRE(INI::File::IncludeCacheSize() == 0);
+    INI::File::SetIncludeCacheLimit(limit);
+    // cyclic inclusion is an error
+    std::ofstream((dir / "pseudo.ini").string()) << ";#include ./main.ini\n";
+    INI::File cyclic;
+    REQUIRE_FALSE(cyclic.Load((dir / "main.ini").string()));
+    REQUIRE(cyclic.LastResult().error_code == INI_ERR_INCLUDE_CYCLE);
+    INI::File::ClearIncludeCache();
+    std::filesystem::remove_all(dir);
+  }
 }